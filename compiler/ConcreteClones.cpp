@@ -0,0 +1,189 @@
+// This file is part of SymCC.
+//
+// SymCC is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ConcreteClones.h"
+
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+using namespace llvm;
+
+namespace {
+
+constexpr char kCloneSuffix[] = ".symcc.concrete";
+
+/// Decide whether the pointer refers to a local variable or, if the access
+/// only reads, to a constant global.
+bool isLocalObject(const Value *pointer, const DataLayout &dataLayout,
+                   bool readOnly) {
+#if LLVM_VERSION_MAJOR >= 12
+  (void)dataLayout;
+  auto *object = getUnderlyingObject(pointer);
+#else
+  auto *object = GetUnderlyingObject(pointer, dataLayout);
+#endif
+  if (isa<AllocaInst>(object))
+    return true;
+
+  auto *global = dyn_cast<GlobalVariable>(object);
+  return readOnly && global != nullptr && global->isConstant();
+}
+
+} // namespace
+
+ConcreteClones::ConcreteClones(Module &M, bool enabled) : module(&M) {
+  if (!enabled)
+    return;
+
+  DenseSet<const Function *> eligible;
+  for (auto &F : M) {
+    if (isCandidate(F))
+      eligible.insert(&F);
+  }
+  removeOpenCallers(eligible);
+
+  DenseSet<const Function *> pure;
+  for (auto *F : eligible) {
+    if (std::all_of(inst_begin(F), inst_end(F), [](const Instruction &I) {
+          auto *call = dyn_cast<CallBase>(&I);
+          return (call != nullptr && !call->getCalledFunction()->isIntrinsic())
+                     ? true
+                     : isLocalAccess(I);
+        }))
+      pure.insert(F);
+  }
+  removeOpenCallers(pure);
+
+  // Clone in module order, so that the output is deterministic.
+  SmallVector<Function *, 0> originals;
+  for (auto &F : M) {
+    if (eligible.count(&F) != 0)
+      originals.push_back(&F);
+  }
+
+  for (auto *F : originals) {
+    ValueToValueMapTy valueMap;
+    auto *clone = CloneFunction(F, valueMap);
+    clone->setName(F->getName() + kCloneSuffix);
+    clone->setLinkage(GlobalValue::InternalLinkage);
+    // The clone must stay even if the linker discards F's comdat in favor of
+    // another module's copy: our other clones may call it.
+    clone->setComdat(nullptr);
+
+    clones[F] = clone;
+    clonedFunctions.insert(clone);
+    if (pure.count(F) != 0)
+      pureFunctions.insert(F);
+  }
+
+  // Clones only call each other, never the instrumented functions.
+  for (auto &[original, clone] : clones) {
+    for (auto &I : instructions(*clone)) {
+      if (auto *call = dyn_cast<CallBase>(&I)) {
+        if (auto *calleeClone = getClone(*call->getCalledFunction()))
+          call->setCalledFunction(calleeClone);
+      }
+    }
+  }
+}
+
+Function *ConcreteClones::getClone(const Function &F) const {
+  return clones.lookup(&F);
+}
+
+bool ConcreteClones::isCandidate(const Function &F) {
+  // We need the definition that all callers use, and we can't forward
+  // variable arguments or arguments that live in the caller's frame in special
+  // ways.
+  if (F.isDeclarationForLinker() || F.isInterposable() || F.isVarArg() ||
+      F.hasFnAttribute(Attribute::Naked))
+    return false;
+
+  for (auto &arg : F.args()) {
+    if (arg.hasInAllocaAttr() || arg.hasSwiftErrorAttr())
+      return false;
+#if LLVM_VERSION_MAJOR >= 11
+    if (arg.hasPreallocatedAttr())
+      return false;
+#endif
+  }
+
+  SmallVector<const Function *, 4> calledFunctions;
+  for (auto &B : F) {
+    if (B.hasAddressTaken())
+      return false;
+
+    for (auto &I : B) {
+      auto *call = dyn_cast<CallBase>(&I);
+      if (call == nullptr)
+        continue;
+
+      // Indirect calls and inline assembly may lead anywhere.
+      auto *callee = call->getCalledFunction();
+      if (callee == nullptr)
+        return false;
+      if (!callee->isIntrinsic())
+        calledFunctions.push_back(callee);
+    }
+  }
+
+  callees[&F] = std::move(calledFunctions);
+  return true;
+}
+
+bool ConcreteClones::isLocalAccess(const Instruction &I) {
+  if (!I.mayReadOrWriteMemory())
+    return true;
+
+  auto &dataLayout = I.getModule()->getDataLayout();
+  if (auto *load = dyn_cast<LoadInst>(&I))
+    return isLocalObject(load->getPointerOperand(), dataLayout, true);
+  if (auto *store = dyn_cast<StoreInst>(&I))
+    return isLocalObject(store->getPointerOperand(), dataLayout, false);
+
+  if (auto *transfer = dyn_cast<MemTransferInst>(&I))
+    return isLocalObject(transfer->getRawDest(), dataLayout, false) &&
+           isLocalObject(transfer->getRawSource(), dataLayout, true);
+  if (auto *memset = dyn_cast<MemSetInst>(&I))
+    return isLocalObject(memset->getRawDest(), dataLayout, false);
+
+  if (auto *intrinsic = dyn_cast<IntrinsicInst>(&I)) {
+    return intrinsic->getIntrinsicID() == Intrinsic::lifetime_start ||
+           intrinsic->getIntrinsicID() == Intrinsic::lifetime_end;
+  }
+
+  return false;
+}
+
+void ConcreteClones::removeOpenCallers(DenseSet<const Function *> &functions) {
+  while (true) {
+    SmallVector<const Function *, 8> open;
+    for (auto *F : functions) {
+      const auto &calledFunctions = callees[F];
+      if (std::any_of(calledFunctions.begin(), calledFunctions.end(),
+                      [&functions](const Function *callee) {
+                        return functions.count(callee) == 0;
+                      }))
+        open.push_back(F);
+    }
+
+    if (open.empty())
+      return;
+
+    for (auto *F : open)
+      functions.erase(F);
+  }
+}
@@ -0,0 +1,97 @@
+// This file is part of SymCC.
+//
+// SymCC is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CONCRETECLONES_H
+#define CONCRETECLONES_H
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+
+/// Uninstrumented copies of the module's functions.
+///
+/// Hot functions are often called many times with entirely concrete data, yet
+/// their instrumented versions still exchange parameter expressions with the
+/// run-time library and check every intermediate result for concreteness. For
+/// each function that qualifies, we therefore keep an uninstrumented clone,
+/// and the instrumented function starts with a cheap check that calls the
+/// clone if no symbolic data can reach the computation.
+///
+/// A function qualifies if it only calls intrinsics and other functions with a
+/// clone (which the clone calls instead), because the clone must neither
+/// obtain symbolic data nor lose the expressions of anything that it passes to
+/// instrumented code. Clones are only useful if we can tell at run time that
+/// no symbolic data is around:
+///
+/// - In general, this is the case until the program has obtained its first
+///   symbolic input byte (see _sym_symbolic_mode).
+/// - Pure functions, i.e., those whose clones only access their own local
+///   variables and constant globals, are fine whenever their arguments are
+///   concrete.
+class ConcreteClones {
+public:
+  /// Create clones of all qualifying functions in the module, or none if the
+  /// optimization is disabled.
+  ///
+  /// This must happen before any of the module's functions is instrumented.
+  ConcreteClones(llvm::Module &M, bool enabled);
+
+  /// Are these the clones of the given module?
+  bool analyzes(const llvm::Module &M) const { return &M == module; }
+
+  /// The uninstrumented clone of the function, or null if it doesn't have one.
+  llvm::Function *getClone(const llvm::Function &F) const;
+
+  /// Is the function one of the clones (which must not be instrumented)?
+  bool isClone(const llvm::Function &F) const {
+    return clonedFunctions.count(&F) != 0;
+  }
+
+  /// Can the clone of the function run whenever its arguments are concrete?
+  bool isPure(const llvm::Function &F) const {
+    return pureFunctions.count(&F) != 0;
+  }
+
+private:
+  /// Check the conditions that a function has to satisfy by itself, and record
+  /// its callees.
+  bool isCandidate(const llvm::Function &F);
+
+  /// Decide whether the instruction (other than a call to a function with a
+  /// clone) only accesses local variables and constant globals.
+  static bool isLocalAccess(const llvm::Instruction &I);
+
+  /// Remove functions with callees outside the set until nothing changes.
+  void removeOpenCallers(llvm::DenseSet<const llvm::Function *> &functions);
+
+  const llvm::Module *module;
+
+  /// The (non-intrinsic) functions that each candidate calls.
+  llvm::DenseMap<const llvm::Function *,
+                 llvm::SmallVector<const llvm::Function *, 4>>
+      callees;
+
+  /// The functions with a clone, and their clones.
+  llvm::DenseMap<const llvm::Function *, llvm::Function *> clones;
+
+  /// The clones.
+  llvm::DenseSet<const llvm::Function *> clonedFunctions;
+
+  /// The functions with a clone that is pure.
+  llvm::DenseSet<const llvm::Function *> pureFunctions;
+};
+
+#endif
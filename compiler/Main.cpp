@@ -13,15 +13,23 @@
 // SymCC. If not, see <https://www.gnu.org/licenses/>.
 
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Pass.h>
 #if LLVM_VERSION_MAJOR <= 15
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #endif
+#include <llvm/Transforms/InstCombine/InstCombine.h>
 #include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/Scalar/Scalarizer.h>
+#include <llvm/Transforms/Scalar/GVN.h>
 
 #if LLVM_VERSION_MAJOR >= 13
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Passes/PassPlugin.h>
+#include <llvm/Transforms/Scalar/DeadStoreElimination.h>
+#include <llvm/Transforms/Scalar/EarlyCSE.h>
+#include <llvm/Transforms/Scalar/JumpThreading.h>
+#include <llvm/Transforms/Scalar/LICM.h>
+#include <llvm/Transforms/Scalar/LoopPassManager.h>
+#include <llvm/Transforms/Scalar/SimplifyCFG.h>
 
 #if LLVM_VERSION_MAJOR >= 14
 #include <llvm/Passes/OptimizationLevel.h>
@@ -40,23 +48,57 @@ using OptimizationLevel = llvm::PassBuilder::OptimizationLevel;
 
 using namespace llvm;
 
+#if LLVM_VERSION_MAJOR == 13
+using GVNPass = GVN;
+#endif
+
+namespace {
+
+/// Should we optimize the code after instrumenting it?
+///
+/// Our instrumentation mostly follows the structure of the original code, so
+/// it contains a lot of redundancy that general-purpose optimizations can
+/// remove: the same expression is checked for null before each computation
+/// that uses it, the result of a skipped computation is checked again by the
+/// next one, and the many small blocks that short-circuiting introduces can
+/// often be merged.
+/// Similar to MSan, we therefore run a few scalar optimizations after
+/// instrumentation (unless the program is compiled without optimization).
+bool optimizeInstrumentation() {
+  return getFlag("SYMCC_OPTIMIZE_INSTRUMENTATION", true);
+}
+
+} // namespace
+
 //
 // Legacy pass registration (up to LLVM 13)
 //
 
 #if LLVM_VERSION_MAJOR <= 15
 
-void addSymbolizeLegacyPass(const PassManagerBuilder & /* unused */,
+void addSymbolizeLegacyPass(const PassManagerBuilder &builder,
                             legacy::PassManagerBase &PM) {
-  PM.add(createScalarizerPass());
   PM.add(createLowerAtomicPass());
   PM.add(new SymbolizeLegacyPass());
+
+  if (builder.OptLevel > 0 && optimizeInstrumentation()) {
+    PM.add(createEarlyCSEPass(/* UseMemorySSA */ true));
+    PM.add(createInstructionCombiningPass());
+    PM.add(createCFGSimplificationPass());
+    PM.add(createJumpThreadingPass());
+    PM.add(createLICMPass());
+    PM.add(createGVNPass());
+    PM.add(createDeadStoreEliminationPass());
+    PM.add(createCFGSimplificationPass());
+  }
 }
 
 // Make the pass known to opt.
 static RegisterPass<SymbolizeLegacyPass> X("symbolize", "Symbolization Pass");
-// Tell frontends to run the pass automatically.
-static struct RegisterStandardPasses Y(PassManagerBuilder::EP_VectorizerStart,
+// Tell frontends to run the pass automatically. We instrument the fully
+// optimized code, so that the optimizer doesn't need to deal with our
+// instrumentation and we don't instrument code that it would remove anyway.
+static struct RegisterStandardPasses Y(PassManagerBuilder::EP_OptimizerLast,
                                        addSymbolizeLegacyPass);
 static struct RegisterStandardPasses
     Z(PassManagerBuilder::EP_EnabledOnOptLevel0, addSymbolizeLegacyPass);
@@ -74,18 +116,51 @@ PassPluginLibraryInfo getSymbolizePluginInfo() {
           [](PassBuilder &PB) {
             // We need to act on the entire module as well as on each function.
             // Those actions are independent from each other, so we register a
-            // module pass at the start of the pipeline and a function pass just
-            // before the vectorizer. (There doesn't seem to be a way to run
-            // module passes at the start of the vectorizer, hence the split.)
+            // module pass at the start of the pipeline and a function pass at
+            // the very end, where we instrument the fully optimized (and
+            // possibly vectorized) code.
             PB.registerPipelineStartEPCallback(
                 [](ModulePassManager &PM, OptimizationLevel) {
                   PM.addPass(SymbolizePass());
                 });
-            PB.registerVectorizerStartEPCallback(
-                [](FunctionPassManager &PM, OptimizationLevel) {
-                  PM.addPass(ScalarizerPass());
-                  PM.addPass(LowerAtomicPass());
-                  PM.addPass(SymbolizePass());
+            PB.registerOptimizerLastEPCallback(
+                [](ModulePassManager &PM, OptimizationLevel level) {
+                  // Function passes must not add functions to the module, so
+                  // a module pass creates the concrete clones (and runs the
+                  // taint analysis) before we instrument the functions.
+                  auto instrumentation =
+                      std::make_shared<ModuleInstrumentation>();
+
+                  FunctionPassManager LowerFPM;
+                  LowerFPM.addPass(LowerAtomicPass());
+                  PM.addPass(
+                      createModuleToFunctionPassAdaptor(std::move(LowerFPM)));
+                  PM.addPass(PrepareSymbolizePass(instrumentation));
+
+                  FunctionPassManager FPM;
+                  FPM.addPass(SymbolizePass(instrumentation));
+
+                  if (level != OptimizationLevel::O0 &&
+                      optimizeInstrumentation()) {
+                    FPM.addPass(EarlyCSEPass(/* UseMemorySSA */ true));
+                    FPM.addPass(InstCombinePass());
+                    FPM.addPass(SimplifyCFGPass());
+                    FPM.addPass(JumpThreadingPass());
+                    FPM.addPass(createFunctionToLoopPassAdaptor(
+#if LLVM_VERSION_MAJOR >= 15
+                        LICMPass(LICMOptions()),
+#else
+                        LICMPass(),
+#endif
+                        /* UseMemorySSA */ true));
+                    FPM.addPass(GVNPass());
+                    FPM.addPass(DSEPass());
+                    FPM.addPass(SimplifyCFGPass());
+                  }
+
+                  PM.addPass(
+                      createModuleToFunctionPassAdaptor(std::move(FPM)));
+                  PM.addPass(FinishSymbolizePass(instrumentation));
                 });
           }};
 }
@@ -14,13 +14,20 @@
 
 #include "Pass.h"
 
+#include <cstdlib>
+#include <map>
+#include <memory>
+
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
 #include <llvm/CodeGen/IntrinsicLowering.h>
 #include <llvm/CodeGen/TargetLowering.h>
 #include <llvm/CodeGen/TargetSubtargetInfo.h>
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/Transforms/Utils/ModuleUtils.h>
@@ -31,8 +38,10 @@
 #include <llvm/MC/TargetRegistry.h>
 #endif
 
+#include "ConcreteClones.h"
 #include "Runtime.h"
 #include "Symbolizer.h"
+#include "TaintAnalysis.h"
 
 using namespace llvm;
 
@@ -47,6 +56,22 @@ using namespace llvm;
 
 char SymbolizeLegacyPass::ID = 0;
 
+bool getFlag(const char *name, bool defaultValue) {
+  auto *value = getenv(name);
+  if (value == nullptr)
+    return defaultValue;
+
+  auto flag = StringRef(value).lower();
+  if (flag == "1" || flag == "on" || flag == "yes")
+    return true;
+  if (flag.empty() || flag == "0" || flag == "off" || flag == "no")
+    return false;
+
+  errs() << "Warning: ignoring unknown value " << value << " of " << name
+         << '\n';
+  return defaultValue;
+}
+
 namespace {
 
 static constexpr char kSymCtorName[] = "__sym_ctor";
@@ -159,11 +184,89 @@ void liftInlineAssembly(CallInst *CI) {
   targetLowering->ExpandInlineAsm(CI);
 }
 
-bool instrumentFunction(Function &F) {
+/// Append a record of the function's instrumentation to the given file.
+///
+/// All compiler invocations of a build append to the same file, one line of
+/// JSON per function. Each line goes out in a single write, so parallel
+/// compilations don't garble each other's records.
+void writeStatistics(const char *path, Function &F, size_t numInstructions,
+                     size_t concreteInstructions,
+                     const Symbolizer::Statistics &statistics, bool hasClone) {
+  std::map<StringRef, size_t> runtimeCalls;
+  for (auto &I : instructions(F)) {
+    if (auto *call = dyn_cast<CallBase>(&I)) {
+      auto *callee = call->getCalledFunction();
+      if (callee != nullptr && callee->getName().startswith("_sym_"))
+        runtimeCalls[callee->getName()]++;
+    }
+  }
+
+  json::Object calls;
+  for (auto &[name, count] : runtimeCalls)
+    calls[name] = count;
+
+  std::string record;
+  raw_string_ostream recordStream(record);
+  json::OStream J(recordStream);
+  J.object([&] {
+    J.attribute("module", F.getParent()->getSourceFileName());
+    J.attribute("function", F.getName());
+    J.attribute("instructions", numInstructions);
+    J.attribute("proven_concrete", concreteInstructions);
+    J.attribute("instrumented_size", F.getInstructionCount());
+    J.attribute("symbolic_computations", statistics.symbolicComputations);
+    J.attribute("merged_regions", statistics.mergedRegions);
+    J.attribute("merged_computations", statistics.mergedComputations);
+    J.attribute("memory_accesses", statistics.memoryAccesses);
+    J.attribute("constant_expressions", statistics.constantExpressions);
+    J.attribute("concretizations", statistics.concretizations);
+    J.attribute("concrete_clone", hasClone);
+    J.attribute("runtime_calls", std::move(calls));
+  });
+  recordStream << '\n';
+  recordStream.flush();
+
+  std::error_code error;
+  raw_fd_ostream out(path, error, sys::fs::OF_Append);
+  if (error) {
+    errs() << "Warning: can't write instrumentation statistics to " << path
+           << ": " << error.message() << '\n';
+    return;
+  }
+  // A buffered stream would split records that exceed its buffer.
+  out.SetUnbuffered();
+  out << record;
+}
+
+} // namespace
+
+ModuleInstrumentation::ModuleInstrumentation() = default;
+ModuleInstrumentation::~ModuleInstrumentation() = default;
+
+void ModuleInstrumentation::prepare(Module &M) {
+  concreteClones = std::make_unique<ConcreteClones>(
+      M, getFlag("SYMCC_CONCRETE_CLONES", true));
+  taintAnalysis =
+      std::make_unique<TaintAnalysis>(M, getFlag("SYMCC_STATIC_TAINT", true));
+}
+
+void ModuleInstrumentation::release() {
+  taintAnalysis.reset();
+  concreteClones.reset();
+}
+
+bool ModuleInstrumentation::instrumentFunction(Function &F) const {
+  assert(taintAnalysis && concreteClones &&
+         taintAnalysis->analyzes(*F.getParent()) &&
+         "The instrumentation hasn't been prepared for this module");
+
   auto functionName = F.getName();
   if (functionName == kSymCtorName)
     return false;
 
+  if (concreteClones->isClone(F))
+    return false;
+
   DEBUG(errs() << "Symbolizing function ");
   DEBUG(errs().write_escaped(functionName) << '\n');
 
@@ -187,17 +290,42 @@ bool instrumentFunction(Function &F) {
   for (auto &I : instructions(F))
     allInstructions.push_back(&I);
 
-  Symbolizer symbolizer(*F.getParent());
+  Symbolizer symbolizer(*F.getParent(), *taintAnalysis);
   symbolizer.symbolizeFunctionArguments(F);
 
   for (auto &basicBlock : F)
     symbolizer.insertBasicBlockNotification(basicBlock);
 
-  for (auto *instPtr : allInstructions)
-    symbolizer.visit(instPtr);
+  size_t concreteInstructions = 0;
+  for (auto *instPtr : allInstructions) {
+    if (symbolizer.isProvablyConcrete(*instPtr))
+      concreteInstructions++;
+    else
+      symbolizer.symbolizeInstruction(*instPtr);
+  }
+
+  if (getFlag("SYMCC_TAINT_REPORT", false)) {
+    errs() << "SymCC: ";
+    errs().write_escaped(functionName)
+        << ": " << concreteInstructions << " of " << allInstructions.size()
+        << " instructions proven concrete\n";
+  }
 
   symbolizer.finalizePHINodes();
-  symbolizer.shortCircuitExpressionUses();
+  symbolizer.shortCircuitExpressionUses(getFlag("SYMCC_MERGE_CHECKS", true));
+  symbolizer.guardMemoryAccesses(getFlag("SYMCC_INLINE_SHADOW_CHECKS", true));
+  if (getFlag("SYMCC_CACHE_CONSTANTS", true))
+    symbolizer.cacheConstantExpressions();
+
+  auto *clone = concreteClones->getClone(F);
+  if (clone != nullptr)
+    symbolizer.dispatchToConcreteClone(F, *clone, concreteClones->isPure(F));
+
+  auto *statisticsPath = getenv("SYMCC_INSTRUMENTATION_STATS");
+  if (statisticsPath != nullptr && *statisticsPath != '\0')
+    writeStatistics(statisticsPath, F, allInstructions.size(),
+                    concreteInstructions, symbolizer.getStatistics(),
+                    clone != nullptr);
 
   // DEBUG(errs() << F << '\n');
   assert(!verifyFunction(F, &errs()) &&
@@ -206,21 +334,32 @@ bool instrumentFunction(Function &F) {
   return true;
 }
 
-} // namespace
-
 bool SymbolizeLegacyPass::doInitialization(Module &M) {
   return instrumentModule(M);
 }
 
-bool SymbolizeLegacyPass::runOnFunction(Function &F) {
-  return instrumentFunction(F);
+bool SymbolizeLegacyPass::runOnModule(Module &M) {
+  ModuleInstrumentation instrumentation;
+  instrumentation.prepare(M);
+
+  // Instrumentation adds declarations of run-time functions to the module.
+  SmallVector<Function *, 0> functions;
+  for (auto &F : M.functions()) {
+    if (!F.isDeclaration())
+      functions.push_back(&F);
+  }
+
+  for (auto *F : functions)
+    instrumentation.instrumentFunction(*F);
+
+  return true;
 }
 
 #if LLVM_VERSION_MAJOR >= 13
 
 PreservedAnalyses SymbolizePass::run(Function &F, FunctionAnalysisManager &) {
-  return instrumentFunction(F) ? PreservedAnalyses::none()
-                               : PreservedAnalyses::all();
+  return instrumentation->instrumentFunction(F) ? PreservedAnalyses::none()
+                                                : PreservedAnalyses::all();
 }
 
 PreservedAnalyses SymbolizePass::run(Module &M, ModuleAnalysisManager &) {
@@ -228,4 +367,10 @@ PreservedAnalyses SymbolizePass::run(Module &M, ModuleAnalysisManager &) {
                              : PreservedAnalyses::all();
 }
 
+PreservedAnalyses PrepareSymbolizePass::run(Module &M,
+                                            ModuleAnalysisManager &) {
+  instrumentation->prepare(M);
+  return PreservedAnalyses::none();
+}
+
 #endif
@@ -15,6 +15,8 @@
 #ifndef PASS_H
 #define PASS_H
 
+#include <memory>
+
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/ValueMap.h>
 #include <llvm/Pass.h>
@@ -23,25 +25,105 @@
 #include <llvm/IR/PassManager.h>
 #endif
 
-class SymbolizeLegacyPass : public llvm::FunctionPass {
+/// Read a Boolean option from the environment.
+///
+/// With the new pass manager, clang loads the pass after parsing its command
+/// line, so we can't use -mllvm options.
+bool getFlag(const char *name, bool defaultValue);
+
+class ConcreteClones;
+class TaintAnalysis;
+
+/// The module-level information that the instrumentation of each function
+/// uses.
+///
+/// The taint analysis is interprocedural, and creating the concrete clones adds
+/// functions to the module, so neither can happen in a function pass. Instead,
+/// a module pass computes them right before the functions are instrumented
+/// (i.e., after all optimizations that precede us in the pipeline), and they
+/// are released as soon as the last function is done.
+class ModuleInstrumentation {
+public:
+  ModuleInstrumentation();
+  ~ModuleInstrumentation();
+
+  /// Analyze the module and create the concrete clones.
+  void prepare(llvm::Module &M);
+
+  /// Instrument one of the module's functions; prepare must have been called.
+  bool instrumentFunction(llvm::Function &F) const;
+
+  void release();
+
+private:
+  std::unique_ptr<TaintAnalysis> taintAnalysis;
+  std::unique_ptr<ConcreteClones> concreteClones;
+};
+
+class SymbolizeLegacyPass : public llvm::ModulePass {
 public:
   static char ID;
 
-  SymbolizeLegacyPass() : FunctionPass(ID) {}
+  SymbolizeLegacyPass() : ModulePass(ID) {}
 
   virtual bool doInitialization(llvm::Module &M) override;
-  virtual bool runOnFunction(llvm::Function &F) override;
+  virtual bool runOnModule(llvm::Module &M) override;
 };
 
 #if LLVM_VERSION_MAJOR >= 13
 
+/// Instrument a module (at the start of the pipeline) or a function (at the
+/// end, after PrepareSymbolizePass).
 class SymbolizePass : public llvm::PassInfoMixin<SymbolizePass> {
 public:
+  SymbolizePass() = default;
+  explicit SymbolizePass(
+      std::shared_ptr<const ModuleInstrumentation> instrumentation)
+      : instrumentation(std::move(instrumentation)) {}
+
   llvm::PreservedAnalyses run(llvm::Function &F,
                               llvm::FunctionAnalysisManager &);
   llvm::PreservedAnalyses run(llvm::Module &M, llvm::ModuleAnalysisManager &);
 
   static bool isRequired() { return true; }
+
+private:
+  std::shared_ptr<const ModuleInstrumentation> instrumentation;
+};
+
+/// Prepare the instrumentation of the module's functions, which a
+/// SymbolizePass sharing the same ModuleInstrumentation performs.
+class PrepareSymbolizePass : public llvm::PassInfoMixin<PrepareSymbolizePass> {
+public:
+  explicit PrepareSymbolizePass(
+      std::shared_ptr<ModuleInstrumentation> instrumentation)
+      : instrumentation(std::move(instrumentation)) {}
+
+  llvm::PreservedAnalyses run(llvm::Module &M, llvm::ModuleAnalysisManager &);
+
+  static bool isRequired() { return true; }
+
+private:
+  std::shared_ptr<ModuleInstrumentation> instrumentation;
+};
+
+/// Release the information that PrepareSymbolizePass computed, once all
+/// functions are instrumented.
+class FinishSymbolizePass : public llvm::PassInfoMixin<FinishSymbolizePass> {
+public:
+  explicit FinishSymbolizePass(
+      std::shared_ptr<ModuleInstrumentation> instrumentation)
+      : instrumentation(std::move(instrumentation)) {}
+
+  llvm::PreservedAnalyses run(llvm::Module &, llvm::ModuleAnalysisManager &) {
+    instrumentation->release();
+    return llvm::PreservedAnalyses::all();
+  }
+
+  static bool isRequired() { return true; }
+
+private:
+  std::shared_ptr<ModuleInstrumentation> instrumentation;
 };
 
 #endif
@@ -74,6 +74,10 @@ Runtime::Runtime(Module &M) {
              ptrT); // doesn't follow naming convention for historic reasons
   pushPathConstraint =
       import(M, "_sym_push_path_constraint", voidT, ptrT, int1T, intPtrType);
+  pushSwitchConstraint =
+      import(M, "_sym_push_switch_constraint", voidT, ptrT,
+             IRB.getInt64Ty()->getPointerTo(), intPtrType, intPtrType,
+             intPtrType);
 
   // Overflow arithmetic
   buildAddOverflow =
@@ -187,6 +191,18 @@ Runtime::Runtime(Module &M) {
   notifyCall = import(M, "_sym_notify_call", voidT, intPtrType);
   notifyRet = import(M, "_sym_notify_ret", voidT, intPtrType);
   notifyBasicBlock = import(M, "_sym_notify_basic_block", voidT, intPtrType);
+
+  registerExpressionRegion = import(M, "_sym_register_expression_region",
+                                    voidT, ptrT->getPointerTo(), intPtrType);
+
+  symbolicMode = M.getOrInsertGlobal("_sym_symbolic_mode", int8T);
+
+  shadowAddressBits = intPtrType->getBitWidth() == 64 ? 47 : 32;
+  shadowTable = M.getOrInsertGlobal(
+      "_sym_shadow_table",
+      ArrayType::get(intPtrType, uint64_t(1) << (shadowAddressBits -
+                                                 kShadowLeafBits -
+                                                 kShadowPageBits)));
 }
 
 /// Decide whether a function is called symbolically.
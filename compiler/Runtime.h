@@ -24,6 +24,11 @@ using SymFnT = llvm::Value *;
 using SymFnT = llvm::FunctionCallee;
 #endif
 
+/// The layout of the run-time library's shadow page table (see
+/// _sym_shadow_table in RuntimeCommon.h).
+constexpr unsigned kShadowPageBits = 12;
+constexpr unsigned kShadowLeafBits = 17;
+
 /// Runtime functions
 struct Runtime {
   Runtime(llvm::Module &M);
@@ -65,6 +70,7 @@ struct Runtime {
   SymFnT buildAbs{};
   SymFnT buildConcat{};
   SymFnT pushPathConstraint{};
+  SymFnT pushSwitchConstraint{};
   SymFnT getParameterExpression{};
   SymFnT setParameterExpression{};
   SymFnT setReturnExpression{};
@@ -80,6 +86,14 @@ struct Runtime {
   SymFnT notifyCall{};
   SymFnT notifyRet{};
   SymFnT notifyBasicBlock{};
+  SymFnT registerExpressionRegion{};
+
+  /// The flag that indicates whether the program has seen symbolic input yet.
+  llvm::Value *symbolicMode{};
+
+  /// The shadow page table, covering addresses below 2^shadowAddressBits.
+  llvm::Value *shadowTable{};
+  unsigned shadowAddressBits{};
 
   /// Mapping from icmp predicates to the functions that build the corresponding
   /// symbolic expressions.
@@ -17,7 +17,9 @@
 #include <cstdint>
 #include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/IR/Constants.h>
+#include <llvm/IR/DebugInfoMetadata.h>
 #include <llvm/IR/GetElementPtrTypeIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
 #include <llvm/IR/Intrinsics.h>
 #include <llvm/Transforms/Utils/BasicBlockUtils.h>
 
@@ -25,6 +27,60 @@
 
 using namespace llvm;
 
+#if LLVM_VERSION_MAJOR < 11
+using FixedVectorType = VectorType;
+#endif
+
+namespace {
+
+/// The largest memory access (in bytes) for which we check the individual
+/// shadow slots inline; beyond that, we only check whether the page is
+/// concrete.
+constexpr uint64_t kMaxInlineSlotChecks = 16;
+
+/// Decide whether the vector version of an intrinsic applies the scalar
+/// version to each lane, and whether we know how to handle the latter.
+bool isElementwiseIntrinsic(Intrinsic::ID id) {
+  switch (id) {
+  case Intrinsic::bswap:
+  case Intrinsic::fabs:
+  case Intrinsic::fshl:
+  case Intrinsic::fshr:
+  case Intrinsic::sadd_sat:
+  case Intrinsic::uadd_sat:
+  case Intrinsic::ssub_sat:
+  case Intrinsic::usub_sat:
+#if LLVM_VERSION_MAJOR > 11
+  case Intrinsic::sshl_sat:
+  case Intrinsic::ushl_sat:
+  case Intrinsic::abs:
+#endif
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Decide whether the instruction computes a vector by applying a scalar
+/// operation to each lane.
+bool isElementwise(const Instruction &I) {
+  if (!isa<FixedVectorType>(I.getType()))
+    return false;
+
+  if (isa<BinaryOperator>(I) || isa<UnaryOperator>(I) || isa<CmpInst>(I))
+    return true;
+  if (isa<CastInst>(I))
+    return !isa<BitCastInst>(I);
+  if (auto *select = dyn_cast<SelectInst>(&I))
+    return select->getCondition()->getType()->isVectorTy();
+  if (auto *intrinsic = dyn_cast<IntrinsicInst>(&I))
+    return isElementwiseIntrinsic(intrinsic->getIntrinsicID());
+
+  return false;
+}
+
+} // namespace
+
 void Symbolizer::symbolizeFunctionArguments(Function &F) {
   // The main function doesn't receive symbolic arguments.
   if (F.getName() == "main")
@@ -33,9 +89,12 @@ void Symbolizer::symbolizeFunctionArguments(Function &F) {
   IRBuilder<> IRB(F.getEntryBlock().getFirstNonPHI());
 
   for (auto &arg : F.args()) {
-    if (!arg.user_empty())
-      symbolicExpressions[&arg] = IRB.CreateCall(runtime.getParameterExpression,
-                                                 IRB.getInt8(arg.getArgNo()));
+    if (!arg.user_empty() && taint.mayBeSymbolic(&arg)) {
+      auto *expr = IRB.CreateCall(runtime.getParameterExpression,
+                                  IRB.getInt8(arg.getArgNo()));
+      symbolicExpressions[&arg] = expr;
+      parameterExpressions.push_back(expr);
+    }
   }
 }
 
@@ -44,6 +103,109 @@ void Symbolizer::insertBasicBlockNotification(llvm::BasicBlock &B) {
   IRB.CreateCall(runtime.notifyBasicBlock, getTargetPreferredInt(&B));
 }
 
+bool Symbolizer::isProvablyConcrete(Instruction &I) const {
+  if (auto *store = dyn_cast<StoreInst>(&I))
+    return taint.isConcreteVariable(store->getPointerOperand());
+
+  if (I.getType()->isVoidTy() || isa<CallBase>(I))
+    return false;
+
+  return !taint.mayBeSymbolic(&I);
+}
+
+void Symbolizer::symbolizeInstruction(Instruction &I) {
+  if (isElementwise(I))
+    symbolizeLanes(I);
+  else
+    visit(I);
+}
+
+void Symbolizer::symbolizeLanes(Instruction &I) {
+  if (std::none_of(I.op_begin(), I.op_end(), [this](Value *operand) {
+        return getSymbolicExpression(operand) != nullptr;
+      }))
+    return;
+
+  if (!isSupportedVector(I.getType()) ||
+      std::any_of(I.op_begin(), I.op_end(), [this](Value *operand) {
+        return operand->getType()->isVectorTy() &&
+               !isSupportedVector(operand->getType());
+      })) {
+    errs() << "Warning: unsupported vector operation " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
+  auto *vectorType = cast<FixedVectorType>(I.getType());
+  auto *previous = I.getPrevNode();
+  auto numComputations = expressionUses.size();
+
+  IRBuilder<> IRB(&I);
+  std::vector<Input> inputs;
+  SmallVector<Instruction *, 32> laneInstructions;
+  Value *result = nullptr;
+  for (unsigned lane = 0; lane < vectorType->getNumElements(); lane++) {
+    // Build a scalar copy of the operation for the current lane.
+    auto *scalar = I.clone();
+    for (auto &operand : scalar->operands()) {
+      auto *vector = operand.get();
+      if (!vector->getType()->isVectorTy())
+        continue;
+
+      auto *element =
+          ExtractElementInst::Create(vector, IRB.getInt32(lane), "", &I);
+      if (auto *constant = dyn_cast<Constant>(vector)) {
+        symbolicExpressions[element] =
+            createValueExpression(constant->getAggregateElement(lane), IRB);
+      } else {
+        auto extraction = buildElementExtract(IRB, vector, IRB.getInt32(lane));
+        inputs.insert(inputs.end(), extraction.inputs.begin(),
+                      extraction.inputs.end());
+        symbolicExpressions[element] = extraction.lastInstruction;
+      }
+
+      operand.set(element);
+      laneInstructions.push_back(element);
+    }
+
+    if (auto *call = dyn_cast<CallInst>(scalar)) {
+      call->setCalledFunction(Intrinsic::getDeclaration(
+          I.getModule(), cast<IntrinsicInst>(I).getIntrinsicID(),
+          {vectorType->getElementType()}));
+    }
+    scalar->mutateType(vectorType->getElementType());
+    scalar->insertBefore(&I);
+    laneInstructions.push_back(scalar);
+
+    // The regular visitor method builds the lane's expression.
+    visit(*scalar);
+    Value *laneExpr = getSymbolicExpression(scalar);
+    if (laneExpr == nullptr)
+      laneExpr = createValueExpression(scalar, IRB);
+
+    laneExpr = buildMemoryBytes(IRB, scalar, laneExpr);
+    result = (result == nullptr)
+                 ? laneExpr
+                 : IRB.CreateCall(runtime.buildConcat, {result, laneExpr});
+  }
+
+  // The computations for the individual lanes are part of ours, so they
+  // mustn't be short-circuited separately.
+  expressionUses.resize(numComputations);
+
+  // Scalar copies whose concrete values we don't need are dead.
+  for (auto *laneInstruction : reverse(laneInstructions)) {
+    symbolicExpressions.erase(laneInstruction);
+    if (laneInstruction->use_empty())
+      laneInstruction->eraseFromParent();
+  }
+
+  auto *first = (previous != nullptr) ? previous->getNextNode()
+                                      : &I.getParent()->front();
+  registerSymbolicComputation(
+      SymbolicComputation(first, cast<Instruction>(result), inputs), &I);
+}
+
 void Symbolizer::finalizePHINodes() {
   SmallPtrSet<PHINode *, 32> nodesToErase;
 
@@ -80,25 +242,44 @@ void Symbolizer::finalizePHINodes() {
   symbolicExpressions.clear();
 }
 
-void Symbolizer::shortCircuitExpressionUses() {
+void Symbolizer::shortCircuitExpressionUses(bool mergeChecks) {
+  // Group straight-line computations into regions with a common check first;
+  // the checks of the individual computations below then only run if the
+  // region has symbolic inputs.
+  if (mergeChecks) {
+    for (size_t start = 0; start < expressionUses.size();)
+      start = guardComputationRegion(start);
+  }
+
   for (auto &symbolicComputation : expressionUses) {
     assert(!symbolicComputation.inputs.empty() &&
            "Symbolic computation has no inputs");
 
     IRBuilder<> IRB(symbolicComputation.firstInstruction);
 
+    // Several inputs may refer to the same value (e.g., when a computation
+    // extracts multiple lanes of a vector); we check each value and create its
+    // expression only once.
+    using InputKey = std::pair<Value *, Value *>;
+    std::vector<InputKey> inputKeys;
+    for (const auto &input : symbolicComputation.inputs)
+      inputKeys.emplace_back(input.getSymbolicOperand(), input.concreteValue);
+
     // Build the check whether any input expression is non-null (i.e., there
     // is a symbolic input).
     auto *nullExpression =
         ConstantPointerNull::get(IRB.getInt8Ty()->getPointerTo());
-    std::vector<Value *> nullChecks;
-    for (const auto &input : symbolicComputation.inputs) {
-      nullChecks.push_back(
-          IRB.CreateICmpEQ(nullExpression, input.getSymbolicOperand()));
-    }
-    auto *allConcrete = nullChecks[0];
-    for (unsigned argIndex = 1; argIndex < nullChecks.size(); argIndex++) {
-      allConcrete = IRB.CreateAnd(allConcrete, nullChecks[argIndex]);
+    DenseMap<InputKey, Value *> nullChecks;
+    Value *allConcrete = nullptr;
+    for (const auto &key : inputKeys) {
+      auto [checkIt, isNew] = nullChecks.try_emplace(key);
+      if (!isNew)
+        continue;
+
+      checkIt->second = IRB.CreateICmpEQ(nullExpression, key.first);
+      allConcrete = (allConcrete == nullptr)
+                        ? checkIt->second
+                        : IRB.CreateAnd(allConcrete, checkIt->second);
     }
 
     // The main branch: if we don't enter here, we can short-circuit the
@@ -114,15 +295,22 @@ void Symbolizer::shortCircuitExpressionUses() {
     // In the slow case, we need to check each input expression for null
     // (i.e., the input is concrete) and create an expression from the
     // concrete value if necessary.
-    auto numUnknownConcreteness = std::count_if(
-        symbolicComputation.inputs.begin(), symbolicComputation.inputs.end(),
-        [&](const Input &input) {
-          return (input.getSymbolicOperand() != nullExpression);
-        });
+    auto numUnknownConcreteness =
+        std::count_if(nullChecks.begin(), nullChecks.end(),
+                      [&](const std::pair<InputKey, Value *> &check) {
+                        return (check.first.first != nullExpression);
+                      });
+    DenseMap<InputKey, Value *> finalArgExpressions;
     for (unsigned argIndex = 0; argIndex < symbolicComputation.inputs.size();
          argIndex++) {
       auto &argument = symbolicComputation.inputs[argIndex];
       auto *originalArgExpression = argument.getSymbolicOperand();
+      const auto &key = inputKeys[argIndex];
+      if (auto finalIt = finalArgExpressions.find(key);
+          finalIt != finalArgExpressions.end()) {
+        argument.replaceOperand(finalIt->second);
+        continue;
+      }
       auto *argCheckBlock = symbolicComputation.firstInstruction->getParent();
 
       // We only need a run-time check for concreteness if the argument isn't
@@ -137,7 +325,7 @@ void Symbolizer::shortCircuitExpressionUses() {
 
       if (needRuntimeCheck) {
         auto *argExpressionBlock = SplitBlockAndInsertIfThen(
-            nullChecks[argIndex], symbolicComputation.firstInstruction,
+            nullChecks[key], symbolicComputation.firstInstruction,
             /* unreachable */ false);
         IRB.SetInsertPoint(argExpressionBlock);
       } else {
@@ -159,6 +347,7 @@ void Symbolizer::shortCircuitExpressionUses() {
       }
 
       argument.replaceOperand(finalArgExpression);
+      finalArgExpressions[key] = finalArgExpression;
     }
 
     // Finally, the overall result (if the computation produces one) is null
@@ -177,9 +366,380 @@ void Symbolizer::shortCircuitExpressionUses() {
   }
 }
 
+size_t Symbolizer::guardComputationRegion(size_t start) {
+  // The instructions of the region's computations, the values that they take
+  // from outside the region, and the concrete instructions in between.
+  SmallPtrSet<Value *, 16> regionValues;
+  SmallVector<Value *, 8> externalInputs;
+  SmallVector<Instruction *, 8> concreteInstructions;
+
+  auto addComputation = [&](const SymbolicComputation &computation) {
+    for (auto *I = computation.firstInstruction;
+         I != computation.lastInstruction->getNextNode(); I = I->getNextNode())
+      regionValues.insert(I);
+
+    for (const auto &input : computation.inputs) {
+      auto *operand = input.getSymbolicOperand();
+      if (!isa<ConstantPointerNull>(operand) &&
+          regionValues.count(operand) == 0 &&
+          !is_contained(externalInputs, operand))
+        externalInputs.push_back(operand);
+    }
+  };
+
+  // A computation can join the region if only concrete instructions that we
+  // can move before the region separate it from the previous one, and if it
+  // shares an input with the region or uses one of its results.
+  auto canJoin = [&](const SymbolicComputation &previous,
+                     const SymbolicComputation &next,
+                     SmallVectorImpl<Instruction *> &inBetween) {
+    auto *block = previous.lastInstruction->getParent();
+    if (next.firstInstruction->getParent() != block ||
+        next.lastInstruction->getParent() != block)
+      return false;
+
+    auto *I = previous.lastInstruction->getNextNode();
+    for (; I != nullptr && I != next.firstInstruction; I = I->getNextNode()) {
+      if (isa<PHINode>(I) || isa<AllocaInst>(I) || I->isTerminator() ||
+          I->mayReadOrWriteMemory() || I->mayHaveSideEffects() ||
+          std::any_of(I->op_begin(), I->op_end(), [&](Value *operand) {
+            return regionValues.count(operand) != 0;
+          }))
+        return false;
+      inBetween.push_back(I);
+    }
+    if (I == nullptr)
+      return false;
+
+    return std::any_of(
+        next.inputs.begin(), next.inputs.end(), [&](const Input &input) {
+          auto *operand = input.getSymbolicOperand();
+          return regionValues.count(operand) != 0 ||
+                 is_contained(externalInputs, operand);
+        });
+  };
+
+  const auto &first = expressionUses[start];
+  if (first.firstInstruction->getParent() !=
+      first.lastInstruction->getParent())
+    return start + 1;
+
+  addComputation(first);
+  auto end = start + 1;
+  for (; end < expressionUses.size(); end++) {
+    SmallVector<Instruction *, 4> inBetween;
+    if (!canJoin(expressionUses[end - 1], expressionUses[end], inBetween))
+      break;
+
+    addComputation(expressionUses[end]);
+    concreteInstructions.append(inBetween.begin(), inBetween.end());
+  }
+
+  // A single computation has its own check, and a region whose inputs are all
+  // known to be concrete never runs anyway.
+  if (end - start < 2 || externalInputs.empty())
+    return end;
+
+  auto *firstInstruction = first.firstInstruction;
+  auto *lastInstruction = expressionUses[end - 1].lastInstruction;
+
+  // Code after the region receives null for all results if we skip it; this
+  // only works for expressions.
+  SmallVector<Instruction *, 4> escapingValues;
+  for (auto *I = firstInstruction; I != lastInstruction->getNextNode();
+       I = I->getNextNode()) {
+    if (regionValues.count(I) == 0)
+      continue;
+    if (std::any_of(I->user_begin(), I->user_end(), [&](User *user) {
+          return regionValues.count(user) == 0;
+        })) {
+      if (!I->getType()->isPointerTy())
+        return end;
+      escapingValues.push_back(I);
+    }
+  }
+
+  for (auto *I : concreteInstructions)
+    I->moveBefore(firstInstruction);
+
+  IRBuilder<> IRB(firstInstruction);
+  auto *nullExpression =
+      ConstantPointerNull::get(IRB.getInt8Ty()->getPointerTo());
+  Value *allConcrete = nullptr;
+  for (auto *input : externalInputs) {
+    auto *check = IRB.CreateICmpEQ(nullExpression, input);
+    allConcrete =
+        (allConcrete == nullptr) ? check : IRB.CreateAnd(allConcrete, check);
+  }
+
+  auto *head = firstInstruction->getParent();
+  auto *body = SplitBlock(head, firstInstruction);
+  auto *tail = SplitBlock(body, lastInstruction->getNextNode());
+  ReplaceInstWithInst(head->getTerminator(),
+                      BranchInst::Create(tail, body, allConcrete));
+
+  for (auto *value : escapingValues) {
+    auto *finalValue = PHINode::Create(value->getType(), 2, "", &tail->front());
+    value->replaceUsesOutsideBlock(finalValue, body);
+    finalValue->addIncoming(
+        ConstantPointerNull::get(cast<PointerType>(value->getType())), head);
+    finalValue->addIncoming(value, body);
+  }
+
+  statistics.mergedRegions++;
+  statistics.mergedComputations += end - start;
+  return end;
+}
+
+void Symbolizer::guardMemoryAccesses(bool inlineShadowChecks) {
+  for (auto *access : memoryAccesses) {
+    IRBuilder<> IRB(access);
+    auto *symbolicMode = IRB.CreateICmpNE(
+        IRB.CreateLoad(IRB.getInt8Ty(), runtime.symbolicMode), IRB.getInt8(0));
+
+    auto *accessTerminator = SplitBlockAndInsertIfThen(
+        symbolicMode, access, /* unreachable */ false);
+    auto *tail = access->getParent();
+    access->moveBefore(accessTerminator);
+    if (inlineShadowChecks)
+      checkShadowInline(access, tail);
+
+    if (!access->use_empty()) {
+      IRB.SetInsertPoint(&tail->front());
+      auto *finalExpression = IRB.CreatePHI(access->getType(), 2);
+      access->replaceAllUsesWith(finalExpression);
+      for (auto *predecessor : predecessors(tail)) {
+        finalExpression->addIncoming(
+            predecessor == access->getParent()
+                ? static_cast<Value *>(access)
+                : ConstantPointerNull::get(
+                      cast<PointerType>(access->getType())),
+            predecessor);
+      }
+    }
+  }
+}
+
+void Symbolizer::checkShadowInline(CallInst *access, BasicBlock *skip) {
+  auto *check = access->getParent();
+  auto *call = SplitBlock(check, access);
+  check->getTerminator()->eraseFromParent();
+
+  auto &context = check->getContext();
+  auto *function = check->getParent();
+  auto *addr = access->getArgOperand(0);
+  auto size = cast<ConstantInt>(access->getArgOperand(1))->getZExtValue();
+  auto pageSize = uint64_t(1) << kShadowPageBits;
+
+  // Accesses larger than a page span several pages, which only the run-time
+  // library can check.
+  IRBuilder<> IRB(check);
+  if (size > pageSize) {
+    IRB.CreateBr(call);
+    return;
+  }
+
+  // Writes (which don't return anything) of symbolic expressions always need
+  // the run-time library.
+  Value *mayBeConcrete = IRB.getTrue();
+  if (access->getType()->isVoidTy()) {
+    auto *expr = access->getArgOperand(2);
+    mayBeConcrete = IRB.CreateICmpEQ(
+        expr, ConstantPointerNull::get(cast<PointerType>(expr->getType())));
+  }
+
+  // The region has to lie within a single page that the table covers.
+  auto *offset =
+      IRB.CreateAnd(addr, ConstantInt::get(intPtrType, pageSize - 1));
+  if (size > 1) {
+    auto *lastOffset = ConstantInt::get(intPtrType, pageSize - size);
+    mayBeConcrete = IRB.CreateAnd(mayBeConcrete,
+                                  IRB.CreateICmpULE(offset, lastOffset));
+  }
+  if (runtime.shadowAddressBits < ptrBits) {
+    auto *limit =
+        ConstantInt::get(intPtrType, uint64_t(1) << runtime.shadowAddressBits);
+    mayBeConcrete =
+        IRB.CreateAnd(mayBeConcrete, IRB.CreateICmpULT(addr, limit));
+  }
+
+  auto *lookupLeaf = BasicBlock::Create(context, "", function, call);
+  IRB.CreateCondBr(mayBeConcrete, lookupLeaf, call);
+
+  // The page is concrete if there is no leaf for it, or if the leaf doesn't
+  // contain a shadow.
+  IRB.SetInsertPoint(lookupLeaf);
+  auto *leaf = IRB.CreateLoad(
+      intPtrType,
+      IRB.CreateInBoundsGEP(
+          intPtrType,
+          IRB.CreateBitCast(runtime.shadowTable, intPtrType->getPointerTo()),
+          IRB.CreateLShr(addr, kShadowLeafBits + kShadowPageBits)));
+  auto *lookupPage = BasicBlock::Create(context, "", function, call);
+  IRB.CreateCondBr(IRB.CreateICmpEQ(leaf, ConstantInt::get(intPtrType, 0)),
+                   skip, lookupPage);
+
+  IRB.SetInsertPoint(lookupPage);
+  auto *pageIndex =
+      IRB.CreateAnd(IRB.CreateLShr(addr, kShadowPageBits),
+                    ConstantInt::get(intPtrType,
+                                     (uint64_t(1) << kShadowLeafBits) - 1));
+  auto *page = IRB.CreateLoad(
+      intPtrType,
+      IRB.CreateInBoundsGEP(
+          intPtrType, IRB.CreateIntToPtr(leaf, intPtrType->getPointerTo()),
+          pageIndex));
+  auto *pageIsConcrete =
+      IRB.CreateICmpEQ(page, ConstantInt::get(intPtrType, 0));
+
+  // If the page has a shadow, small regions may still be concrete; we check
+  // their shadow slots in one go.
+  if (size > kMaxInlineSlotChecks) {
+    IRB.CreateCondBr(pageIsConcrete, skip, call);
+    return;
+  }
+
+  auto *checkSlots = BasicBlock::Create(context, "", function, call);
+  IRB.CreateCondBr(pageIsConcrete, skip, checkSlots);
+
+  IRB.SetInsertPoint(checkSlots);
+  auto *slotsType = size > 1 ? static_cast<Type *>(
+                                   FixedVectorType::get(intPtrType, size))
+                             : intPtrType;
+  Value *slots = IRB.CreateAlignedLoad(
+      slotsType,
+      IRB.CreateIntToPtr(
+          IRB.CreateAdd(page,
+                        IRB.CreateMul(offset, ConstantInt::get(
+                                                  intPtrType, ptrBits / 8))),
+          slotsType->getPointerTo()),
+#if LLVM_VERSION_MAJOR >= 10
+      Align(ptrBits / 8)
+#else
+      ptrBits / 8
+#endif
+  );
+  if (size > 1)
+    slots = IRB.CreateOrReduce(slots);
+  IRB.CreateCondBr(IRB.CreateICmpEQ(slots, ConstantInt::get(intPtrType, 0)),
+                   skip, call);
+}
+
+void Symbolizer::cacheConstantExpressions() {
+  if (constantExpressions.empty())
+    return;
+
+  // Each distinct constant gets a slot in the function's table.
+  DenseMap<Constant *, unsigned> slots;
+  for (const auto &[call, constant] : constantExpressions)
+    slots.try_emplace(constant, slots.size());
+
+  auto &F = *constantExpressions.front().first->getFunction();
+  auto &M = *F.getParent();
+  IRBuilder<> IRB(M.getContext());
+  auto *exprT = IRB.getInt8Ty()->getPointerTo();
+  auto *tableType = ArrayType::get(exprT, slots.size());
+  auto *table = new GlobalVariable(M, tableType, /* isConstant */ false,
+                                   GlobalValue::PrivateLinkage,
+                                   ConstantAggregateZero::get(tableType),
+                                   F.getName() + ".symcc.constants");
+  auto *registered = new GlobalVariable(
+      M, IRB.getInt1Ty(), /* isConstant */ false, GlobalValue::PrivateLinkage,
+      IRB.getFalse(), F.getName() + ".symcc.constants.registered");
+
+  for (const auto &[call, constant] : constantExpressions) {
+    IRB.SetInsertPoint(call);
+    auto *slot =
+        IRB.CreateConstInBoundsGEP2_32(tableType, table, 0, slots[constant]);
+    auto *cached = IRB.CreateLoad(exprT, slot);
+    auto *head = cached->getParent();
+    auto *buildTerminator = SplitBlockAndInsertIfThen(
+        IRB.CreateIsNull(cached), call, /* unreachable */ false);
+    auto *tail = call->getParent();
+    call->moveBefore(buildTerminator);
+
+    IRB.SetInsertPoint(&tail->front());
+    auto *finalExpression = IRB.CreatePHI(exprT, 2);
+    call->replaceAllUsesWith(finalExpression);
+
+    // The garbage collector needs to know about the cached expressions; the
+    // table stays registered even if the run-time library clears it (e.g., in
+    // persistent mode), so we register it on the first miss only.
+    IRB.SetInsertPoint(buildTerminator);
+    IRB.CreateStore(call, slot);
+    auto *registerTerminator = SplitBlockAndInsertIfThen(
+        IRB.CreateNot(IRB.CreateLoad(IRB.getInt1Ty(), registered)),
+        buildTerminator, /* unreachable */ false);
+    IRB.SetInsertPoint(registerTerminator);
+    IRB.CreateCall(runtime.registerExpressionRegion,
+                   {IRB.CreateConstInBoundsGEP2_32(tableType, table, 0, 0),
+                    ConstantInt::get(intPtrType, slots.size())});
+    IRB.CreateStore(IRB.getTrue(), registered);
+
+    finalExpression->addIncoming(cached, head);
+    finalExpression->addIncoming(call, buildTerminator->getParent());
+  }
+}
+
+void Symbolizer::dispatchToConcreteClone(Function &F, Function &clone,
+                                         bool pure) {
+  auto *instrumented = &F.getEntryBlock();
+  auto *entry = BasicBlock::Create(F.getContext(), "", &F, instrumented);
+  auto *useClone = BasicBlock::Create(F.getContext(), "", &F, instrumented);
+
+  // Static allocas have to stay in the entry block.
+  for (auto &I : make_early_inc_range(*instrumented)) {
+    if (auto *alloca = dyn_cast<AllocaInst>(&I);
+        alloca != nullptr && isa<Constant>(alloca->getArraySize()))
+      alloca->moveBefore(*entry, entry->end());
+  }
+
+  IRBuilder<> IRB(entry);
+  Value *concrete = IRB.getTrue();
+  if (pure) {
+    for (auto *expr : parameterExpressions) {
+      expr->moveBefore(*entry, entry->end());
+      concrete = IRB.CreateAnd(
+          IRB.CreateICmpEQ(expr, ConstantPointerNull::get(
+                                     cast<PointerType>(expr->getType()))),
+          concrete);
+    }
+  } else {
+    concrete = IRB.CreateICmpEQ(
+        IRB.CreateLoad(IRB.getInt8Ty(), runtime.symbolicMode), IRB.getInt8(0));
+  }
+  IRB.CreateCondBr(concrete, useClone, instrumented);
+
+  IRB.SetInsertPoint(useClone);
+  // The verifier insists on a location for calls that may be inlined.
+  if (auto *subprogram = F.getSubprogram())
+    IRB.SetCurrentDebugLocation(DILocation::get(
+        F.getContext(), subprogram->getLine(), 0, subprogram));
+  SmallVector<Value *, 8> args;
+  for (auto &arg : F.args())
+    args.push_back(&arg);
+  auto *result = IRB.CreateCall(&clone, args);
+  result->setCallingConv(clone.getCallingConv());
+  result->setAttributes(clone.getAttributes());
+  result->setTailCall();
+  if (F.getReturnType()->isVoidTy())
+    IRB.CreateRetVoid();
+  else
+    IRB.CreateRet(result);
+}
+
 void Symbolizer::handleIntrinsicCall(CallBase &I) {
   auto *callee = I.getCalledFunction();
 
+  // Element-wise intrinsics never get here (see symbolizeInstruction).
+  if (I.getType()->isVectorTy() ||
+      std::any_of(I.arg_begin(), I.arg_end(), [](Value *arg) {
+        return arg->getType()->isVectorTy();
+      })) {
+    handleVectorIntrinsic(I);
+    return;
+  }
+
   switch (callee->getIntrinsicID()) {
   case Intrinsic::dbg_value:
   case Intrinsic::is_constant:
@@ -345,6 +905,74 @@ void Symbolizer::handleIntrinsicCall(CallBase &I) {
   }
 }
 
+void Symbolizer::handleVectorIntrinsic(CallBase &I) {
+  auto *callee = I.getCalledFunction();
+
+  switch (callee->getIntrinsicID()) {
+#if LLVM_VERSION_MAJOR > 11
+  case Intrinsic::vector_reduce_add:
+  case Intrinsic::vector_reduce_mul:
+  case Intrinsic::vector_reduce_and:
+  case Intrinsic::vector_reduce_or:
+  case Intrinsic::vector_reduce_xor: {
+    // Integer reductions combine all lanes with a binary operator.
+
+    auto *vector = I.getArgOperand(0);
+    if (getSymbolicExpression(vector) == nullptr)
+      return;
+    if (!isSupportedVector(vector->getType()))
+      break;
+
+    auto *vectorType = cast<FixedVectorType>(vector->getType());
+    auto *elementType = vectorType->getElementType();
+    unsigned opcode;
+    switch (callee->getIntrinsicID()) {
+    case Intrinsic::vector_reduce_add:
+      // Addition and multiplication of Booleans are "xor" and "and",
+      // respectively.
+      opcode = elementType->isIntegerTy(1) ? Instruction::Xor
+                                           : Instruction::Add;
+      break;
+    case Intrinsic::vector_reduce_mul:
+      opcode = elementType->isIntegerTy(1) ? Instruction::And
+                                           : Instruction::Mul;
+      break;
+    case Intrinsic::vector_reduce_and:
+      opcode = Instruction::And;
+      break;
+    case Intrinsic::vector_reduce_or:
+      opcode = Instruction::Or;
+      break;
+    default:
+      opcode = Instruction::Xor;
+      break;
+    }
+
+    IRBuilder<> IRB(&I);
+    auto handler = getBinaryOperatorHandler(opcode, elementType);
+    SymbolicComputation reduction;
+    for (unsigned lane = 0; lane < vectorType->getNumElements(); lane++) {
+      auto element = buildElementExtract(IRB, vector, IRB.getInt32(lane));
+      auto *accumulator = reduction.lastInstruction;
+      reduction.merge(element);
+      if (accumulator != nullptr) {
+        reduction.lastInstruction =
+            IRB.CreateCall(handler, {accumulator, element.lastInstruction});
+      }
+    }
+
+    registerSymbolicComputation(reduction, &I);
+    return;
+  }
+#endif
+  default:
+    break;
+  }
+
+  errs() << "Warning: unhandled vector intrinsic " << callee->getName()
+         << "; the result will be concretized\n";
+}
+
 void Symbolizer::handleInlineAssembly(CallInst &I) {
   if (I.getType()->isVoidTy()) {
     errs() << "Warning: skipping over inline assembly " << I << '\n';
@@ -375,7 +1003,7 @@ void Symbolizer::handleFunctionCall(CallBase &I, Instruction *returnPoint) {
                    {ConstantInt::get(IRB.getInt8Ty(), arg.getOperandNo()),
                     getSymbolicExpressionOrNull(arg)});
 
-  if (!I.user_empty()) {
+  if (!I.user_empty() && taint.mayBeSymbolic(&I)) {
     // The result of the function is used somewhere later on. Since we have no
     // way of knowing whether the function is instrumented (and thus sets a
     // proper return expression), we have to account for the possibility that
@@ -395,32 +1023,35 @@ void Symbolizer::visitBinaryOperator(BinaryOperator &I) {
   // Binary operators propagate into the symbolic expression.
 
   IRBuilder<> IRB(&I);
-  SymFnT handler = runtime.binaryOperatorHandlers.at(I.getOpcode());
+  SymFnT handler =
+      getBinaryOperatorHandler(I.getOpcode(), I.getOperand(0)->getType());
+  auto runtimeCall =
+      buildRuntimeCall(IRB, handler, {I.getOperand(0), I.getOperand(1)});
+  registerSymbolicComputation(runtimeCall, &I);
+}
 
+SymFnT Symbolizer::getBinaryOperatorHandler(unsigned opcode,
+                                            Type *type) const {
   // Special case: the run-time library distinguishes between "and" and "or"
   // on Boolean values and bit vectors.
-  if (I.getOperand(0)->getType() == IRB.getInt1Ty()) {
-    switch (I.getOpcode()) {
+  if (type->isIntegerTy(1)) {
+    switch (opcode) {
     case Instruction::And:
-      handler = runtime.buildBoolAnd;
-      break;
+      return runtime.buildBoolAnd;
     case Instruction::Or:
-      handler = runtime.buildBoolOr;
-      break;
+      return runtime.buildBoolOr;
     case Instruction::Xor:
-      handler = runtime.buildBoolXor;
-      break;
+      return runtime.buildBoolXor;
     default:
-      errs() << "Can't handle Boolean operator " << I << '\n';
+      errs() << "Can't handle Boolean operator "
+             << Instruction::getOpcodeName(opcode) << '\n';
       llvm_unreachable("Unknown Boolean operator");
-      break;
     }
   }
 
+  SymFnT handler = runtime.binaryOperatorHandlers.at(opcode);
   assert(handler && "Unable to handle binary operator");
-  auto runtimeCall =
-      buildRuntimeCall(IRB, handler, {I.getOperand(0), I.getOperand(1)});
-  registerSymbolicComputation(runtimeCall, &I);
+  return handler;
 }
 
 void Symbolizer::visitUnaryOperator(UnaryOperator &I) {
@@ -531,11 +1162,18 @@ void Symbolizer::visitLoadInst(LoadInst &I) {
   tryAlternative(IRB, addr);
 
   auto *dataType = I.getType();
+  if (dataType->isVectorTy() && !isSupportedVector(dataType, true)) {
+    errs() << "Warning: unsupported vector load " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
   auto *data = IRB.CreateCall(
       runtime.readMemory,
       {IRB.CreatePtrToInt(addr, intPtrType),
        ConstantInt::get(intPtrType, dataLayout.getTypeStoreSize(dataType)),
        IRB.getInt1(isLittleEndian(dataType) ? 1 : 0)});
+  memoryAccesses.push_back(data);
 
   symbolicExpressions[&I] = convertBitVectorExprForType(IRB, data, dataType);
 }
@@ -551,16 +1189,30 @@ void Symbolizer::visitStoreInst(StoreInst &I) {
   // runtime function we call can handle null expressions.
 
   auto V = I.getValueOperand();
+  if (V->getType()->isVectorTy() && !isSupportedVector(V->getType(), true)) {
+    // The stored value is concretized.
+    auto *write = IRB.CreateCall(
+        runtime.writeMemory,
+        {IRB.CreatePtrToInt(I.getPointerOperand(), intPtrType),
+         ConstantInt::get(intPtrType,
+                          dataLayout.getTypeStoreSize(V->getType())),
+         ConstantPointerNull::get(IRB.getInt8Ty()->getPointerTo()),
+         IRB.getInt1(0)});
+    memoryAccesses.push_back(write);
+    return;
+  }
+
   auto maybeConversion =
       convertExprForTypeToBitVectorExpr(IRB, V, getSymbolicExpression(V));
 
-  IRB.CreateCall(
+  auto *write = IRB.CreateCall(
       runtime.writeMemory,
       {IRB.CreatePtrToInt(I.getPointerOperand(), intPtrType),
        ConstantInt::get(intPtrType, dataLayout.getTypeStoreSize(V->getType())),
        maybeConversion ? maybeConversion->lastInstruction
                        : getSymbolicExpressionOrNull(V),
        IRB.getInt1(isLittleEndian(V->getType()) ? 1 : 0)});
+  memoryAccesses.push_back(write);
 }
 
 void Symbolizer::visitGetElementPtrInst(GetElementPtrInst &I) {
@@ -577,6 +1229,12 @@ void Symbolizer::visitGetElementPtrInst(GetElementPtrInst &I) {
     return;
   }
 
+  if (I.getType()->isVectorTy()) {
+    errs() << "Warning: unsupported vector GEP " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
   // If there are no indices or if they are all zero we can return early as
   // well.
   if (std::all_of(I.idx_begin(), I.idx_end(), [](Value *index) {
@@ -655,6 +1313,11 @@ void Symbolizer::visitGetElementPtrInst(GetElementPtrInst &I) {
 }
 
 void Symbolizer::visitBitCastInst(BitCastInst &I) {
+  if (I.getSrcTy()->isVectorTy() || I.getDestTy()->isVectorTy()) {
+    handleVectorBitCast(I);
+    return;
+  }
+
   if (I.getSrcTy()->isIntegerTy() && I.getDestTy()->isFloatingPointTy()) {
     IRBuilder<> IRB(&I);
     auto conversion =
@@ -679,6 +1342,89 @@ void Symbolizer::visitBitCastInst(BitCastInst &I) {
     symbolicExpressions[&I] = expr;
 }
 
+void Symbolizer::handleVectorBitCast(BitCastInst &I) {
+  auto *operand = I.getOperand(0);
+  auto *expr = getSymbolicExpression(operand);
+  if (expr == nullptr)
+    return;
+
+  auto *srcType = I.getSrcTy();
+  auto *destType = I.getDestTy();
+  IRBuilder<> IRB(&I);
+
+  // Vectors and scalars are both represented in memory order, except that we
+  // use the byte order of the target for scalars.
+  SymbolicComputation conversion;
+  auto currentExpr = [&]() -> std::pair<Value *, bool> {
+    if (conversion.lastInstruction == nullptr)
+      return {operand, true};
+    return {conversion.lastInstruction, false};
+  };
+  auto isByteScalar = [](Type *type) {
+    return type->isFloatingPointTy() ||
+           (type->isIntegerTy() && type->getIntegerBitWidth() % 8 == 0);
+  };
+
+  if (isSupportedVector(srcType, true) && isSupportedVector(destType, true)) {
+    symbolicExpressions[&I] = expr;
+    return;
+  }
+
+  if (isSupportedVector(srcType, true) && isByteScalar(destType)) {
+    if (isLittleEndian(destType) && dataLayout.getTypeStoreSize(destType) > 1)
+      conversion.merge(
+          forceBuildRuntimeCall(IRB, runtime.buildBswap, {currentExpr()}));
+    if (destType->isFloatingPointTy())
+      conversion.merge(forceBuildRuntimeCall(
+          IRB, runtime.buildBitsToFloat,
+          {currentExpr(), {IRB.getInt1(destType->isDoubleTy()), false}}));
+  } else if (isByteScalar(srcType) && isSupportedVector(destType, true)) {
+    if (srcType->isFloatingPointTy())
+      conversion.merge(forceBuildRuntimeCall(IRB, runtime.buildFloatToBits,
+                                             {currentExpr()}));
+    if (isLittleEndian(srcType) && dataLayout.getTypeStoreSize(srcType) > 1)
+      conversion.merge(
+          forceBuildRuntimeCall(IRB, runtime.buildBswap, {currentExpr()}));
+  } else if (isSupportedVector(srcType) && destType->isIntegerTy() &&
+             cast<VectorType>(srcType)->getElementType()->isIntegerTy(1)) {
+    // Vectors of Booleans (e.g., the results of vector comparisons) are
+    // commonly cast to integers to obtain bit masks. The first lane becomes
+    // the least significant bit on little-endian targets and the most
+    // significant bit on big-endian targets.
+    auto numLanes = cast<FixedVectorType>(srcType)->getNumElements();
+    for (unsigned lane = 0; lane < numLanes; lane++) {
+      auto laneByte = forceBuildRuntimeCall(
+          IRB, runtime.buildExtract,
+          {{operand, true},
+           {IRB.getInt64(lane), false},
+           {IRB.getInt64(1), false},
+           {IRB.getInt1(0), false}});
+      auto *accumulator = conversion.lastInstruction;
+      conversion.merge(laneByte);
+      conversion.lastInstruction = IRB.CreateCall(
+          runtime.buildTrunc,
+          {laneByte.lastInstruction, ConstantInt::get(IRB.getInt8Ty(), 1)});
+      if (accumulator != nullptr) {
+        conversion.lastInstruction =
+            dataLayout.isLittleEndian()
+                ? IRB.CreateCall(runtime.buildConcat,
+                                 {conversion.lastInstruction, accumulator})
+                : IRB.CreateCall(runtime.buildConcat,
+                                 {accumulator, conversion.lastInstruction});
+      }
+    }
+  } else {
+    errs() << "Warning: unsupported vector bit cast " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
+  if (conversion.lastInstruction == nullptr)
+    symbolicExpressions[&I] = expr;
+  else
+    registerSymbolicComputation(conversion, &I);
+}
+
 void Symbolizer::visitTruncInst(TruncInst &I) {
   IRBuilder<> IRB(&I);
 
@@ -899,6 +1645,118 @@ void Symbolizer::visitExtractValueInst(ExtractValueInst &I) {
       {extractedBits, result, {{target, 0, extractedBits}}}, &I);
 }
 
+void Symbolizer::visitInsertElementInst(InsertElementInst &I) {
+  IRBuilder<> IRB(&I);
+  auto *target = I.getOperand(0);
+  auto *insertedValue = I.getOperand(1);
+  auto *index = I.getOperand(2);
+
+  tryAlternative(IRB, index);
+
+  if (getSymbolicExpression(target) == nullptr &&
+      getSymbolicExpression(insertedValue) == nullptr)
+    return;
+
+  if (!isSupportedVector(I.getType())) {
+    errs() << "Warning: unsupported vector operation " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
+  // This works like insertvalue, except that the offset may be computed at
+  // run time.
+  auto maybeConversion = convertExprForTypeToBitVectorExpr(
+      IRB, insertedValue, getSymbolicExpressionOrNull(insertedValue));
+
+  auto insert = IRB.CreateCall(
+      runtime.buildInsert,
+      {getSymbolicExpressionOrNull(target),
+       maybeConversion ? maybeConversion->lastInstruction
+                       : getSymbolicExpressionOrNull(insertedValue),
+       buildElementOffset(IRB, I.getType(), index),
+       IRB.getInt1(isLittleEndian(insertedValue->getType()) ? 1 : 0)});
+  auto insertComputation =
+      SymbolicComputation(insert, insert, {Input(target, 0, insert)});
+
+  if (!maybeConversion) {
+    insertComputation.inputs.push_back(Input(insertedValue, 1, insert));
+  } else {
+    maybeConversion->merge(insertComputation);
+  }
+
+  registerSymbolicComputation(maybeConversion.value_or(insertComputation), &I);
+}
+
+void Symbolizer::visitExtractElementInst(ExtractElementInst &I) {
+  IRBuilder<> IRB(&I);
+  auto *vector = I.getVectorOperand();
+
+  tryAlternative(IRB, I.getIndexOperand());
+
+  if (getSymbolicExpression(vector) == nullptr)
+    return;
+
+  if (!isSupportedVector(vector->getType())) {
+    errs() << "Warning: unsupported vector operation " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
+  registerSymbolicComputation(
+      buildElementExtract(IRB, vector, I.getIndexOperand()), &I);
+}
+
+void Symbolizer::visitShuffleVectorInst(ShuffleVectorInst &I) {
+  // The mask is constant, so we know at compile time where each lane of the
+  // result comes from.
+
+  SmallVector<int, 16> mask;
+  I.getShuffleMask(mask);
+  auto numSourceLanes =
+      cast<FixedVectorType>(I.getOperand(0)->getType())->getNumElements();
+
+  if (std::none_of(mask.begin(), mask.end(), [&](int maskElement) {
+        return maskElement >= 0 &&
+               getSymbolicExpression(
+                   I.getOperand(maskElement / numSourceLanes)) != nullptr;
+      }))
+    return;
+
+  if (!isSupportedVector(I.getType())) {
+    errs() << "Warning: unsupported vector operation " << I
+           << "; the result will be concretized\n";
+    return;
+  }
+
+  IRBuilder<> IRB(&I);
+  auto laneSize = dataLayout.getTypeStoreSize(
+      cast<VectorType>(I.getType())->getElementType());
+  SymbolicComputation shuffle;
+  for (int maskElement : mask) {
+    auto *accumulator = shuffle.lastInstruction;
+    if (maskElement < 0) {
+      // The lane is undefined, so any value will do.
+      auto *zero = IRB.CreateCall(runtime.buildZeroBytes,
+                                  {ConstantInt::get(intPtrType, laneSize)});
+      shuffle.merge(SymbolicComputation(zero, zero, {}));
+    } else {
+      shuffle.merge(forceBuildRuntimeCall(
+          IRB, runtime.buildExtract,
+          {{I.getOperand(maskElement / numSourceLanes), true},
+           {IRB.getInt64((maskElement % numSourceLanes) * laneSize), false},
+           {IRB.getInt64(laneSize), false},
+           {IRB.getInt1(0), false}}));
+    }
+
+    if (accumulator != nullptr) {
+      shuffle.lastInstruction = IRB.CreateCall(
+          runtime.buildConcat, {accumulator, shuffle.lastInstruction});
+    }
+  }
+
+  registerSymbolicComputation(shuffle, &I);
+}
+
 void Symbolizer::visitSwitchInst(SwitchInst &I) {
   // Switch compares a value against a set of integer constants; duplicate
   // constants are not allowed
@@ -907,7 +1765,7 @@ void Symbolizer::visitSwitchInst(SwitchInst &I) {
   IRBuilder<> IRB(&I);
   auto *condition = I.getCondition();
   auto *conditionExpr = getSymbolicExpression(condition);
-  if (conditionExpr == nullptr)
+  if (conditionExpr == nullptr || I.getNumCases() == 0)
     return;
 
   // Build a check whether we have a symbolic condition, to be used later.
@@ -916,16 +1774,50 @@ void Symbolizer::visitSwitchInst(SwitchInst &I) {
   auto *constraintBlock = SplitBlockAndInsertIfThen(haveSymbolicCondition, &I,
                                                     /* unreachable */ false);
 
-  // In the constraint block, we push one path constraint per case.
   IRB.SetInsertPoint(constraintBlock);
+  auto conditionBits = condition->getType()->getIntegerBitWidth();
+  if (conditionBits == 1 || conditionBits > 64) {
+    // The case values don't fit into the run-time library's table, or the
+    // condition is a Boolean, which the library can't compare with integers,
+    // so we push one path constraint per case.
+    for (auto &caseHandle : I.cases()) {
+      auto *caseTaken = IRB.CreateICmpEQ(condition, caseHandle.getCaseValue());
+      auto *caseConstraint = IRB.CreateCall(
+          runtime.comparisonHandlers[CmpInst::ICMP_EQ],
+          {conditionExpr,
+           createValueExpression(caseHandle.getCaseValue(), IRB)});
+      IRB.CreateCall(runtime.pushPathConstraint,
+                     {caseConstraint, caseTaken, getTargetPreferredInt(&I)});
+    }
+    return;
+  }
+
+  // Otherwise, we pass all case values to the run-time library at once, so
+  // that it can solve for the alternatives together, along with the index of
+  // the case that we take (or the number of cases for the default).
+  SmallVector<uint64_t, 16> caseValues;
+  Value *takenIndex = ConstantInt::get(intPtrType, I.getNumCases());
   for (auto &caseHandle : I.cases()) {
-    auto *caseTaken = IRB.CreateICmpEQ(condition, caseHandle.getCaseValue());
-    auto *caseConstraint = IRB.CreateCall(
-        runtime.comparisonHandlers[CmpInst::ICMP_EQ],
-        {conditionExpr, createValueExpression(caseHandle.getCaseValue(), IRB)});
-    IRB.CreateCall(runtime.pushPathConstraint,
-                   {caseConstraint, caseTaken, getTargetPreferredInt(&I)});
+    caseValues.push_back(caseHandle.getCaseValue()->getZExtValue());
+    takenIndex = IRB.CreateSelect(
+        IRB.CreateICmpEQ(condition, caseHandle.getCaseValue()),
+        ConstantInt::get(intPtrType, caseHandle.getCaseIndex()), takenIndex);
   }
+
+  auto *caseTableType = ArrayType::get(IRB.getInt64Ty(), caseValues.size());
+  auto *caseTable = new GlobalVariable(
+      *I.getModule(), caseTableType, /* isConstant */ true,
+      GlobalValue::PrivateLinkage,
+      ConstantDataArray::get(I.getContext(), caseValues),
+      I.getFunction()->getName() + ".symcc.cases");
+  caseTable->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+
+  IRB.CreateCall(
+      runtime.pushSwitchConstraint,
+      {conditionExpr,
+       IRB.CreateConstInBoundsGEP2_32(caseTableType, caseTable, 0, 0),
+       ConstantInt::get(intPtrType, caseValues.size()), takenIndex,
+       getTargetPreferredInt(&I)});
 }
 
 void Symbolizer::visitUnreachableInst(UnreachableInst & /*unused*/) {
@@ -943,6 +1835,18 @@ void Symbolizer::visitInstruction(Instruction &I) {
 }
 
 Instruction *Symbolizer::createValueExpression(Value *V, IRBuilder<> &IRB) {
+  auto *expression = buildValueExpression(V, IRB);
+
+  // Constants have the same expression every time, so we may cache it (see
+  // cacheConstantExpressions).
+  if (isa<ConstantInt>(V) || isa<ConstantFP>(V) || isa<ConstantPointerNull>(V))
+    constantExpressions.emplace_back(cast<CallInst>(expression),
+                                     cast<Constant>(V));
+
+  return expression;
+}
+
+Instruction *Symbolizer::buildValueExpression(Value *V, IRBuilder<> &IRB) {
   auto *valueType = V->getType();
 
   if (isa<ConstantPointerNull>(V)) {
@@ -1031,24 +1935,8 @@ Instruction *Symbolizer::createValueExpression(Value *V, IRBuilder<> &IRB) {
         auto element = constantStructValue
                            ? constantStructValue->getAggregateElement(i)
                            : IRB.CreateExtractValue(V, i);
-        auto elementExpr = createValueExpression(element, IRB);
-
-        // The expression may be of a different kind than bit vector; in this
-        // case, we need to convert it.
-        if (auto conversion =
-                convertExprForTypeToBitVectorExpr(IRB, element, elementExpr)) {
-          elementExpr = conversion->lastInstruction;
-        }
-
-        // If the element is represented in little-endian byte order in memory,
-        // swap the bytes.
-        auto elementType = structType->getElementType(i);
-        if (isLittleEndian(elementType) &&
-            dataLayout.getTypeStoreSize(elementType) > 1) {
-          elementExpr = IRB.CreateCall(runtime.buildBswap, {elementExpr});
-        }
-
-        append(elementExpr);
+        append(cast<Instruction>(buildMemoryBytes(
+            IRB, element, createValueExpression(element, IRB))));
 
         offset = structLayout->getElementOffset(i) +
                  dataLayout.getTypeStoreSize(structType->getElementType(i));
@@ -1065,6 +1953,24 @@ Instruction *Symbolizer::createValueExpression(Value *V, IRBuilder<> &IRB) {
     }
   }
 
+  if (auto *vectorType = dyn_cast<FixedVectorType>(valueType)) {
+    // Vectors are represented like arrays (see symbolizeLanes), so we
+    // concatenate the expressions of the lanes.
+    auto *constantVector = dyn_cast<Constant>(V);
+    Instruction *expr = nullptr;
+    for (unsigned lane = 0; lane < vectorType->getNumElements(); lane++) {
+      auto *element = constantVector
+                          ? constantVector->getAggregateElement(lane)
+                          : IRB.CreateExtractElement(V, lane);
+      auto *laneExpr = cast<Instruction>(
+          buildMemoryBytes(IRB, element, createValueExpression(element, IRB)));
+      expr = expr ? IRB.CreateCall(runtime.buildConcat, {expr, laneExpr})
+                  : laneExpr;
+    }
+
+    return expr;
+  }
+
   llvm_unreachable("Unhandled type for constant expression");
 }
 
@@ -1099,9 +2005,80 @@ void Symbolizer::tryAlternative(IRBuilder<> &IRB, Value *V) {
         {destAssertion, IRB.getInt1(true), getTargetPreferredInt(V)});
     registerSymbolicComputation(SymbolicComputation(
         concreteDestExpr, pushAssertion, {Input(V, 0, destAssertion)}));
+    statistics.concretizations++;
   }
 }
 
+Symbolizer::Statistics Symbolizer::getStatistics() const {
+  auto result = statistics;
+  result.symbolicComputations = expressionUses.size();
+  result.memoryAccesses = memoryAccesses.size();
+  result.constantExpressions = constantExpressions.size();
+  return result;
+}
+
+bool Symbolizer::isSupportedVector(Type *type, bool inMemory) const {
+  auto *vectorType = dyn_cast<FixedVectorType>(type);
+  if (vectorType == nullptr)
+    return false;
+
+  auto *elementType = vectorType->getElementType();
+  if (elementType->isIntegerTy(1))
+    return !inMemory;
+  if (elementType->isIntegerTy()) {
+    auto bits = elementType->getIntegerBitWidth();
+    return bits % 8 == 0 && bits <= 128;
+  }
+
+  return elementType->isFloatTy() || elementType->isDoubleTy() ||
+         elementType->isPointerTy();
+}
+
+Value *Symbolizer::buildElementOffset(IRBuilder<> &IRB, Type *vectorType,
+                                      Value *index) const {
+  auto *fixedVectorType = cast<FixedVectorType>(vectorType);
+  auto elementSize =
+      dataLayout.getTypeStoreSize(fixedVectorType->getElementType());
+
+  // Out-of-range indices produce poison, so we can use any lane for them.
+  auto *laneIndex =
+      IRB.CreateURem(IRB.CreateZExtOrTrunc(index, IRB.getInt64Ty()),
+                     IRB.getInt64(fixedVectorType->getNumElements()));
+  return IRB.CreateMul(laneIndex, IRB.getInt64(elementSize));
+}
+
+Symbolizer::SymbolicComputation
+Symbolizer::buildElementExtract(IRBuilder<> &IRB, Value *vector,
+                                Value *index) {
+  auto *elementType = cast<VectorType>(vector->getType())->getElementType();
+  auto *extractedBytes = IRB.CreateCall(
+      runtime.buildExtract,
+      {getSymbolicExpressionOrNull(vector),
+       buildElementOffset(IRB, vector->getType(), index),
+       IRB.getInt64(dataLayout.getTypeStoreSize(elementType)),
+       IRB.getInt1(isLittleEndian(elementType) ? 1 : 0)});
+
+  auto *result = convertBitVectorExprForType(IRB, extractedBytes, elementType);
+  return SymbolicComputation(extractedBytes, result,
+                             {Input(vector, 0, extractedBytes)});
+}
+
+Value *Symbolizer::buildMemoryBytes(IRBuilder<> &IRB, Value *V,
+                                    Value *expr) const {
+  // The expression may be of a different kind than bit vector; in this case,
+  // we need to convert it.
+  if (auto conversion = convertExprForTypeToBitVectorExpr(IRB, V, expr))
+    expr = conversion->lastInstruction;
+
+  // If the value is represented in little-endian byte order in memory, swap
+  // the bytes.
+  auto *type = V->getType();
+  if (isLittleEndian(type) && dataLayout.getTypeStoreSize(type) > 1)
+    expr = IRB.CreateCall(runtime.buildBswap, {expr});
+
+  return expr;
+}
+
 uint64_t Symbolizer::aggregateMemberOffset(Type *aggregateType,
                                            ArrayRef<unsigned> indices) const {
   uint64_t offset = 0;
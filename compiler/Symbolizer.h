@@ -23,11 +23,12 @@
 #include <optional>
 
 #include "Runtime.h"
+#include "TaintAnalysis.h"
 
 class Symbolizer : public llvm::InstVisitor<Symbolizer> {
 public:
-  explicit Symbolizer(llvm::Module &M)
-      : runtime(M), dataLayout(M.getDataLayout()),
+  Symbolizer(llvm::Module &M, const TaintAnalysis &taint)
+      : runtime(M), taint(taint), dataLayout(M.getDataLayout()),
         ptrBits(M.getDataLayout().getPointerSizeInBits()),
         intPtrType(M.getDataLayout().getIntPtrType(M.getContext())) {}
 
@@ -38,6 +39,20 @@ public:
   /// entry.
   void insertBasicBlockNotification(llvm::BasicBlock &B);
 
+  /// Instrument a single instruction.
+  ///
+  /// Element-wise operations on vectors are split into lanes (see
+  /// symbolizeLanes); everything else goes to the InstVisitor methods below.
+  void symbolizeInstruction(llvm::Instruction &I);
+
+  /// Decide whether an instruction can be left uninstrumented because the
+  /// taint analysis has shown that no symbolic data is involved.
+  ///
+  /// This applies to instructions that compute concrete values (other than
+  /// calls, which have to pass parameter expressions), and to stores to local
+  /// variables that only ever hold concrete data.
+  bool isProvablyConcrete(llvm::Instruction &I) const;
+
   /// Finish the processing of PHI nodes.
   ///
   /// This assumes that there is a dummy PHI node for each such instruction in
@@ -93,11 +108,122 @@ public:
   ///
   /// The resulting code is much longer but avoids solver calls for all
   /// operations without symbolic data.
-  void shortCircuitExpressionUses();
+  ///
+  /// Straight-line arithmetic would turn into a ladder of such checks, so we
+  /// first group adjacent computations that share inputs (or use each other's
+  /// results) into regions with a single check for all their inputs from
+  /// outside the region (see guardComputationRegion), unless mergeChecks is
+  /// false. Concrete execution then skips the entire region at once, and the
+  /// individual checks only run if some input is symbolic.
+  void shortCircuitExpressionUses(bool mergeChecks);
+
+  /// Skip shadow-memory accesses that can't find symbolic data.
+  ///
+  /// Before the run-time library obtains the first symbolic input byte, all
+  /// memory is concrete, so there is no point in calling into the library for
+  /// each load and store. We therefore guard the calls with a check of the
+  /// library's global flag:
+  ///
+  ///   mode = load _sym_symbolic_mode
+  ///   br mode, access, end
+  ///
+  ///   access:
+  ///   expr = call _sym_read_memory(...)
+  ///   br end
+  ///
+  ///   end:
+  ///   final_expr = phi [null, start], [expr, access]
+  ///
+  /// Optionally, we additionally look up the accessed memory in the shadow
+  /// page table (see checkShadowInline), so that even in symbolic mode the
+  /// common case of concrete memory doesn't call into the library.
+  ///
+  /// Like shortCircuitExpressionUses, this needs to run after the main pass.
+  void guardMemoryAccesses(bool inlineShadowChecks);
+
+  /// Build the expressions of constants only once.
+  ///
+  /// Whenever a constant meets a symbolic value, we need an expression for the
+  /// constant; in a loop, the program would build the same one on every
+  /// iteration. Instead, we give each distinct constant a slot in a table of
+  /// cached expressions per function, fill it on first use, and register the
+  /// table with the garbage collector:
+  ///
+  ///   cached = load table[slot]
+  ///   br cached == null, build, end
+  ///
+  ///   build:
+  ///   expr = call _sym_build_integer(42, 32)
+  ///   store expr, table[slot]
+  ///   (call _sym_register_expression_region(table, size) on the first miss)
+  ///   br end
+  ///
+  ///   end:
+  ///   final_expr = phi [cached, start], [expr, build]
+  ///
+  /// Like shortCircuitExpressionUses, this needs to run after the main pass.
+  void cacheConstantExpressions();
+
+  /// Make the function call its uninstrumented clone if no symbolic data can
+  /// reach the computation.
+  ///
+  /// For pure functions (see ConcreteClones), it's enough to check that the
+  /// arguments are concrete; otherwise, we can only use the clone until the
+  /// program has seen symbolic input. The new entry block looks like this:
+  ///
+  ///   entry:
+  ///   (static allocas)
+  ///   expr1 = call _sym_get_parameter_expression(0)
+  ///   ...
+  ///   concrete = and (icmp eq expr1, null), ...
+  ///   br concrete, use_clone, instrumented
+  ///
+  ///   use_clone:
+  ///   result = tail call @f.symcc.concrete(arg1, ...)
+  ///   ret result
+  ///
+  /// This needs to run last, after all other instrumentation.
+  void dispatchToConcreteClone(llvm::Function &F, llvm::Function &clone,
+                               bool pure);
+
+  /// What the instrumentation of a function consists of.
+  struct Statistics {
+    /// Computations that build expressions, each with a concreteness check.
+    size_t symbolicComputations = 0;
+    /// Regions of computations that share a single check (see
+    /// guardComputationRegion), and the computations in them.
+    size_t mergedRegions = 0;
+    size_t mergedComputations = 0;
+    /// Calls to read or write shadow memory.
+    size_t memoryAccesses = 0;
+    /// Expressions of constants, which are cached if enabled.
+    size_t constantExpressions = 0;
+    /// Assertions that pin a symbolic value to its concrete value (see
+    /// tryAlternative).
+    size_t concretizations = 0;
+  };
+
+  /// Report the instrumentation so far; call after the other phases for the
+  /// complete picture.
+  Statistics getStatistics() const;
 
   void handleIntrinsicCall(llvm::CallBase &I);
+  void handleVectorIntrinsic(llvm::CallBase &I);
   void handleInlineAssembly(llvm::CallInst &I);
   void handleFunctionCall(llvm::CallBase &I, llvm::Instruction *returnPoint);
+  void handleVectorBitCast(llvm::BitCastInst &I);
+
+  /// Build the expression of an element-wise vector operation lane by lane.
+  ///
+  /// We represent a vector like an array, i.e., as a single bit vector that
+  /// contains the lanes in memory order (with Booleans occupying one byte
+  /// each). For each lane, we extract the operand lanes from the operand
+  /// expressions, emit a scalar copy of the operation, and let the regular
+  /// visitor method build the lane's expression; finally, we concatenate the
+  /// results. The whole sequence forms a single symbolic computation, so
+  /// concrete vector operations skip it with a single check, and the scalar
+  /// copies only run when there is symbolic data.
+  void symbolizeLanes(llvm::Instruction &I);
 
   //
   // Implementation of InstVisitor
@@ -129,6 +255,9 @@ public:
   void visitPHINode(llvm::PHINode &I);
   void visitInsertValueInst(llvm::InsertValueInst &I);
   void visitExtractValueInst(llvm::ExtractValueInst &I);
+  void visitInsertElementInst(llvm::InsertElementInst &I);
+  void visitExtractElementInst(llvm::ExtractElementInst &I);
+  void visitShuffleVectorInst(llvm::ShuffleVectorInst &I);
   void visitSwitchInst(llvm::SwitchInst &I);
   void visitUnreachableInst(llvm::UnreachableInst &);
   void visitInstruction(llvm::Instruction &I);
@@ -205,6 +334,11 @@ private:
   llvm::Instruction *createValueExpression(llvm::Value *V,
                                            llvm::IRBuilder<> &IRB);
 
+  /// Emit the calls that build the expression of a concrete value (without
+  /// recording constants for cacheConstantExpressions).
+  llvm::Instruction *buildValueExpression(llvm::Value *V,
+                                          llvm::IRBuilder<> &IRB);
+
   /// Get the (already created) symbolic expression for a value.
   llvm::Value *getSymbolicExpression(llvm::Value *V) const {
     auto exprIt = symbolicExpressions.find(V);
@@ -219,10 +353,21 @@ private:
     return expr;
   }
 
-  bool isLittleEndian(llvm::Type *type) {
-    return (!type->isAggregateType() && dataLayout.isLittleEndian());
+  bool isLittleEndian(llvm::Type *type) const {
+    return (!type->isAggregateType() && !type->isVectorTy() &&
+            dataLayout.isLittleEndian());
   }
 
+  /// Decide whether we can represent values of the vector type as expressions
+  /// (see symbolizeLanes). If the representation needs to match the layout in
+  /// memory (e.g., for loads and stores), we can't allow Boolean lanes because
+  /// LLVM packs them into bits.
+  bool isSupportedVector(llvm::Type *type, bool inMemory = false) const;
+
+  /// Select the run-time function for a binary operator on values of the given
+  /// type.
+  SymFnT getBinaryOperatorHandler(unsigned opcode, llvm::Type *type) const;
+
   /// Like buildRuntimeCall, but the call is always generated.
   SymbolicComputation forceBuildRuntimeCall(
       llvm::IRBuilder<> &IRB, SymFnT function,
@@ -280,6 +425,49 @@ private:
       registerSymbolicComputation(*computation, concrete);
   }
 
+  /// Find the longest region of adjacent symbolic computations that starts
+  /// with the given element of expressionUses, and make the code skip the
+  /// region if none of its inputs from outside the region is symbolic:
+  ///
+  ///   start:
+  ///   all_concrete = and (icmp eq 0, expr1), (icmp eq 0, expr2), ...
+  ///   br all_concrete, end, region
+  ///
+  ///   region:
+  ///   ... (the computations, still with their own checks)
+  ///   br end
+  ///
+  ///   end:
+  ///   final_expr = phi [null, start], [sym_expr, region]
+  ///
+  /// Concrete instructions between the computations move before the region.
+  /// Returns the index of the first computation after the region.
+  size_t guardComputationRegion(size_t start);
+
+  /// Replace the unconditional branch to a shadow-memory access with an inline
+  /// check of the shadow page table that jumps to the skip block if the
+  /// accessed memory is concrete. Reads and writes of null expressions need
+  /// the library only if the memory region is symbolic:
+  ///
+  ///   check:
+  ///   br in_one_page, lookup_leaf, access
+  ///
+  ///   lookup_leaf:
+  ///   leaf = load _sym_shadow_table[addr >> 29]
+  ///   br leaf == null, skip, lookup_page
+  ///
+  ///   lookup_page:
+  ///   page = load leaf[(addr >> 12) & 0x1ffff]
+  ///   br page == null, skip, check_slots
+  ///
+  ///   check_slots:
+  ///   slots = load <size x iptr> page[addr & 0xfff]
+  ///   br or_reduce(slots) == 0, skip, access
+  ///
+  /// MSan checks its shadow similarly, but it can use a fixed mapping from
+  /// memory to shadow.
+  void checkShadowInline(llvm::CallInst *access, llvm::BasicBlock *skip);
+
   /// Generate code that makes the solver try an alternative value for V.
   void tryAlternative(llvm::IRBuilder<> &IRB, llvm::Value *V);
 
@@ -308,6 +496,23 @@ private:
   uint64_t aggregateMemberOffset(llvm::Type *aggregateType,
                                  llvm::ArrayRef<unsigned> indices) const;
 
+  /// Emit code that computes the byte offset of a vector element in our
+  /// representation of the vector.
+  llvm::Value *buildElementOffset(llvm::IRBuilder<> &IRB,
+                                  llvm::Type *vectorType,
+                                  llvm::Value *index) const;
+
+  /// Emit code that extracts the expression of a vector element at the given
+  /// index. The result is of the kind that is appropriate for the element type.
+  SymbolicComputation buildElementExtract(llvm::IRBuilder<> &IRB,
+                                          llvm::Value *vector,
+                                          llvm::Value *index);
+
+  /// Emit code that converts the expression of a scalar value to its bytes in
+  /// memory order.
+  llvm::Value *buildMemoryBytes(llvm::IRBuilder<> &IRB, llvm::Value *V,
+                                llvm::Value *expr) const;
+
   /// Emit code that converts the bit-vector expression represented by I to an
   /// expression that is appropriate for T; return the instruction that computes
   /// the result (which may be I if no conversion is needed).
@@ -331,6 +536,9 @@ private:
 
   const Runtime runtime;
 
+  /// The results of the static taint analysis for the module.
+  const TaintAnalysis &taint;
+
   /// The data layout of the currently processed module.
   const llvm::DataLayout &dataLayout;
 
@@ -370,6 +578,20 @@ private:
   /// Therefore, we keep a record of all the places that construct expressions
   /// and insert the fast path later.
   std::vector<SymbolicComputation> expressionUses;
+
+  /// The calls to read and write shadow memory that we've inserted.
+  std::vector<llvm::CallInst *> memoryAccesses;
+
+  /// The calls that build expressions of constants, and the constants.
+  std::vector<std::pair<llvm::CallInst *, llvm::Constant *>>
+      constantExpressions;
+
+  /// The calls that obtain the expressions of the function's arguments.
+  llvm::SmallVector<llvm::CallInst *, 4> parameterExpressions;
+
+  /// The counters of getStatistics that we can't derive from the records
+  /// above.
+  Statistics statistics;
 };
 
 #endif
@@ -0,0 +1,218 @@
+// This file is part of SymCC.
+//
+// SymCC is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+#include "TaintAnalysis.h"
+
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
+
+using namespace llvm;
+
+namespace {
+
+bool isLifetimeMarker(const User *user) {
+  auto *intrinsic = dyn_cast<IntrinsicInst>(user);
+  return intrinsic != nullptr &&
+         (intrinsic->getIntrinsicID() == Intrinsic::lifetime_start ||
+          intrinsic->getIntrinsicID() == Intrinsic::lifetime_end);
+}
+
+/// Decide whether a local variable stays within the function, i.e., whether it
+/// is only loaded, stored to, and marked with lifetime intrinsics.
+bool isLocalVariable(const AllocaInst &variable) {
+  for (const auto *user : variable.users()) {
+    if (isa<LoadInst>(user) || isLifetimeMarker(user))
+      continue;
+
+    if (auto *store = dyn_cast<StoreInst>(user);
+        store != nullptr && store->getValueOperand() != &variable)
+      continue;
+
+    // With typed pointers, lifetime intrinsics take an i8* (and SROA hasn't
+    // necessarily cleaned up after them).
+    if (isa<BitCastInst>(user) &&
+        std::all_of(user->user_begin(), user->user_end(), isLifetimeMarker))
+      continue;
+
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace
+
+TaintAnalysis::TaintAnalysis(Module &M, bool enabled) : module(&M) {
+  if (!enabled)
+    return;
+
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      if (auto *variable = dyn_cast<AllocaInst>(&I);
+          variable != nullptr && isLocalVariable(*variable))
+        localVariables[variable];
+    }
+  }
+
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      if (auto *load = dyn_cast<LoadInst>(&I)) {
+        if (auto *variable = getLocalVariable(load->getPointerOperand()))
+          localVariables[variable].push_back(load);
+      }
+    }
+  }
+
+  for (auto &F : M) {
+    if (!F.isDeclaration())
+      seed(F);
+  }
+
+  while (!worklist.empty())
+    propagate(worklist.pop_back_val());
+
+  for (auto &F : M) {
+    for (auto &arg : F.args()) {
+      if (!tainted.count(&arg))
+        concreteValues[&arg] = true;
+    }
+
+    for (auto &I : instructions(F)) {
+      if (!I.getType()->isVoidTy() && !tainted.count(&I))
+        concreteValues[&I] = true;
+    }
+  }
+
+  for (auto &[variable, loads] : localVariables) {
+    if (!taintedVariables.count(variable))
+      concreteVariables[variable] = true;
+  }
+}
+
+bool TaintAnalysis::mayBeSymbolic(const Value *V) const {
+  if (isa<Constant>(V))
+    return false;
+
+  return concreteValues.count(V) == 0;
+}
+
+bool TaintAnalysis::isConcreteVariable(const Value *pointer) const {
+  return concreteVariables.count(pointer) > 0;
+}
+
+void TaintAnalysis::taint(const Value *V) {
+  if (tainted.insert(V).second)
+    worklist.push_back(V);
+}
+
+void TaintAnalysis::taintVariable(const AllocaInst *variable) {
+  if (!taintedVariables.insert(variable).second)
+    return;
+
+  for (const auto *load : localVariables[variable])
+    taint(load);
+}
+
+void TaintAnalysis::seed(Function &F) {
+  // The main function receives concrete arguments from libc (and the
+  // Symbolizer doesn't create expressions for them either). Arguments of other
+  // functions are only known if we can see all call sites.
+  bool knownCallers =
+      isTracked(&F) && F.hasLocalLinkage() && !F.hasAddressTaken();
+  if (!knownCallers && F.getName() != "main") {
+    for (auto &arg : F.args())
+      taint(&arg);
+  }
+
+  for (auto &I : instructions(F)) {
+    if (I.getType()->isVoidTy())
+      continue;
+
+    if (auto *load = dyn_cast<LoadInst>(&I)) {
+      auto *pointer = load->getPointerOperand();
+      if (getLocalVariable(pointer) != nullptr)
+        continue;
+
+#if LLVM_VERSION_MAJOR >= 12
+      auto *object = getUnderlyingObject(pointer);
+#else
+      auto *object = GetUnderlyingObject(pointer, module->getDataLayout());
+#endif
+      if (auto *global = dyn_cast<GlobalVariable>(object);
+          global != nullptr && global->isConstant())
+        continue;
+
+      taint(load);
+    } else if (auto *call = dyn_cast<CallBase>(&I)) {
+      auto *callee = call->getCalledFunction();
+      if (callee != nullptr && callee->isIntrinsic()) {
+        if (call->mayReadFromMemory())
+          taint(call);
+      } else if (callee == nullptr || !isTracked(callee)) {
+        taint(call);
+      }
+    } else if (I.mayReadFromMemory()) {
+      // For example, va_arg or atomic read-modify-write instructions.
+      taint(&I);
+    }
+  }
+}
+
+void TaintAnalysis::propagate(const Value *V) {
+  for (const auto *user : V->users()) {
+    if (auto *store = dyn_cast<StoreInst>(user)) {
+      if (store->getValueOperand() == V) {
+        if (auto *variable = getLocalVariable(store->getPointerOperand()))
+          taintVariable(variable);
+      }
+    } else if (auto *ret = dyn_cast<ReturnInst>(user)) {
+      auto *F = ret->getFunction();
+      if (!taintedReturns.insert(F).second)
+        continue;
+
+      for (const auto *callUser : F->users()) {
+        if (auto *call = dyn_cast<CallBase>(callUser);
+            call != nullptr && call->getCalledFunction() == F)
+          taint(call);
+      }
+    } else if (auto *call = dyn_cast<CallBase>(user)) {
+      auto *callee = call->getCalledFunction();
+      if (callee != nullptr && callee->isIntrinsic()) {
+        if (!call->getType()->isVoidTy())
+          taint(call);
+      } else if (callee != nullptr && isTracked(callee)) {
+        // Results of calls to other functions are tainted already.
+        for (const auto &arg : call->args()) {
+          if (arg.get() == V && arg.getOperandNo() < callee->arg_size())
+            taint(callee->arg_begin() + arg.getOperandNo());
+        }
+      }
+    } else if (!user->getType()->isVoidTy()) {
+      taint(user);
+    }
+  }
+}
+
+bool TaintAnalysis::isTracked(const Function *F) const {
+  return !F->isDeclaration() && F->hasExactDefinition();
+}
+
+const AllocaInst *TaintAnalysis::getLocalVariable(const Value *pointer) const {
+  auto *variable = dyn_cast<AllocaInst>(pointer);
+  if (variable == nullptr || localVariables.count(variable) == 0)
+    return nullptr;
+
+  return variable;
+}
@@ -0,0 +1,125 @@
+// This file is part of SymCC.
+//
+// SymCC is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TAINTANALYSIS_H
+#define TAINTANALYSIS_H
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/ValueMap.h>
+
+/// A conservative, interprocedural analysis of the values that may carry
+/// symbolic data.
+///
+/// The Symbolizer instruments every value that isn't a compile-time constant
+/// and relies on run-time checks to skip concrete computations. However, large
+/// parts of most programs (think of logging, allocator bookkeeping or
+/// configuration parsing) never see input-derived data, and instrumenting them
+/// only costs time. This analysis finds values that are concrete in every
+/// execution, so that the Symbolizer can leave them alone.
+///
+/// Symbolic data enters the program through memory: read, fread and friends
+/// write input to a buffer, and symcc_make_symbolic marks a buffer as symbolic.
+/// We don't track pointers, so we conservatively assume that the following
+/// values may be symbolic:
+///
+/// - loads, unless they read a constant global or a local variable that doesn't
+///   escape and only ever receives concrete values;
+/// - results of calls, unless the callee is defined in this module and only
+///   returns concrete values;
+/// - arguments of functions that may be called from outside the module or
+///   indirectly, and arguments that receive a potentially symbolic value at
+///   some call site;
+/// - anything computed from a potentially symbolic value.
+///
+/// Everything else is provably concrete.
+class TaintAnalysis {
+public:
+  /// Analyze the module, or create an empty analysis (i.e., one that treats
+  /// all values as potentially symbolic) if the analysis is disabled.
+  TaintAnalysis(llvm::Module &M, bool enabled);
+
+  /// Is this the analysis of the given module?
+  bool analyzes(const llvm::Module &M) const { return &M == module; }
+
+  /// Can the value carry symbolic data at run time?
+  ///
+  /// Values that have been created after the analysis (e.g., by later
+  /// optimizations) are assumed to be potentially symbolic.
+  bool mayBeSymbolic(const llvm::Value *V) const;
+
+  /// Does the pointer refer to a local variable that only ever holds concrete
+  /// data?
+  ///
+  /// Loads and stores of such variables don't need to access shadow memory.
+  bool isConcreteVariable(const llvm::Value *pointer) const;
+
+private:
+  /// A configuration for ValueMap that forgets values when they are replaced,
+  /// not only when they are deleted; the replacement may be symbolic.
+  struct ForgetOnRAUW : llvm::ValueMapConfig<const llvm::Value *> {
+    enum { FollowRAUW = false };
+  };
+
+  using ValueSet = llvm::ValueMap<const llvm::Value *, bool, ForgetOnRAUW>;
+
+  /// Mark a value as potentially symbolic.
+  void taint(const llvm::Value *V);
+
+  /// Mark the contents of a local variable as potentially symbolic.
+  void taintVariable(const llvm::AllocaInst *variable);
+
+  /// Mark all values that are potential sources of symbolic data.
+  void seed(llvm::Function &F);
+
+  /// Propagate the taint of a value to its users.
+  void propagate(const llvm::Value *V);
+
+  /// Is the function's definition the one that all callers use?
+  bool isTracked(const llvm::Function *F) const;
+
+  /// The variable that the pointer refers to, if it's a local variable that
+  /// doesn't escape (whether or not it holds symbolic data).
+  const llvm::AllocaInst *getLocalVariable(const llvm::Value *pointer) const;
+
+  const llvm::Module *module;
+
+  /// The potentially symbolic values found so far.
+  llvm::DenseSet<const llvm::Value *> tainted;
+
+  /// The values still to be propagated.
+  llvm::SmallVector<const llvm::Value *, 64> worklist;
+
+  /// Local variables that don't escape, with the loads that read them.
+  llvm::DenseMap<const llvm::AllocaInst *,
+                 llvm::SmallVector<const llvm::LoadInst *, 4>>
+      localVariables;
+
+  /// The local variables that may receive symbolic data.
+  llvm::DenseSet<const llvm::AllocaInst *> taintedVariables;
+
+  /// The functions that may return symbolic data.
+  llvm::DenseSet<const llvm::Function *> taintedReturns;
+
+  /// The result: arguments and instructions that are provably concrete.
+  ValueSet concreteValues;
+
+  /// The result: local variables that only ever hold concrete data.
+  ValueSet concreteVariables;
+};
+
+#endif
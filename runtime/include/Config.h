@@ -43,6 +43,10 @@ struct Config {
   /// The directory for storing new outputs.
   std::string outputDir = "/tmp/output";
 
+  /// Do we skip test cases that previous executions have already written to
+  /// the output directory (see TestCaseFilter.h)?
+  bool deduplicateAcrossRuns = false;
+
   /// The file to log constraint solving information to.
   std::string logFile = "";
 
@@ -55,6 +59,46 @@ struct Config {
   /// locations across multiple program executions.
   std::string aflCoverageMap = "";
 
+  /// The name of a POSIX shared-memory object holding the AFL coverage map.
+  ///
+  /// This is an alternative to aflCoverageMap that lets concurrent executions
+  /// share their progress immediately.
+  std::string aflCoverageShm = "";
+
+  /// Do we try recently found solutions before querying the solver?
+  bool modelCache = false;
+
+  /// Do we back off from sites whose queries keep failing?
+  bool siteBackoff = false;
+
+  /// The file to write per-site query statistics to at exit.
+  std::string queryStatsFile = "";
+
+  /// The maximum solver timeout per query (in milliseconds).
+  unsigned queryTimeout = 10'000;
+
+  /// The number of seconds after startup when we stop solving (0 for no
+  /// deadline).
+  unsigned solvingDeadline = 0;
+
+  /// Do we act as a fork server (see ForkServer.h)?
+  bool forkServer = false;
+
+  /// The fork server starts at the first read of symbolic input at or after
+  /// this offset, so that the children share the prefix of the execution.
+  unsigned snapshotOffset = 0;
+
+  /// The number of child processes that explore new inputs concurrently (see
+  /// Explorer.h); 0 disables exploration.
+  unsigned exploreWorkers = 0;
+
+  /// The maximum number of executions during exploration.
+  unsigned exploreLimit = 1000;
+
+  /// The number of seconds after which the explorer kills a child (0 for a
+  /// default derived from the solving deadline).
+  unsigned exploreTimeout = 0;
+
   /// The garbage collection threshold.
   ///
   /// We will start collecting unused symbolic expressions if the total number
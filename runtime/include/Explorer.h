@@ -0,0 +1,60 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef EXPLORER_H
+#define EXPLORER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// Fork-based exploration
+//
+// Instead of executing the program from scratch for every new input, the
+// explorer forks the program right before it reads its symbolic input (i.e.,
+// after all input-independent initialization). The parent keeps a queue of
+// inputs and runs each of them in a child process; the children report every
+// new input that the backend generates, and the parent schedules it for
+// execution unless it has seen the same input before. At most the configured
+// number of children run at the same time.
+//
+// The children share nothing but the state at the fork point, so shadow memory
+// and solver state are naturally separate. Each child patches its input before
+// the program reads it: standard input is replaced with an in-memory file,
+// attempts to open the input file are redirected, and memory input is
+// overwritten in symcc_make_symbolic.
+//
+
+/// Start exploring if it is enabled in the configuration.
+///
+/// The libc wrappers call this right before the program opens or reads its
+/// symbolic input for the first time. The function only returns in the
+/// children; the parent exits when exploration is complete.
+void maybeRunExplorer(int inputFileDescriptor);
+
+/// Return the path of a file containing this child's input, or null if the
+/// program should read the original input.
+const char *replacementInputPath();
+
+/// Overwrite the given part of the memory input with this child's input.
+void patchMemoryInput(void *data, size_t length, size_t inputOffset);
+
+/// Hand a newly generated input to the explorer.
+///
+/// This does nothing unless we're running in an exploration child.
+void reportNewInput(const std::vector<uint8_t> &input);
+
+#endif
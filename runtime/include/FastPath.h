@@ -0,0 +1,45 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef FASTPATH_H
+#define FASTPATH_H
+
+#include <array>
+
+#include <Runtime.h>
+
+//
+// The interface between the fast paths of the run-time library (see
+// FastPath.cpp) and the rest of it. Since the fast paths may be inlined into
+// the target program, everything here has to be exported from the library.
+//
+
+constexpr int kMaxFunctionArguments = 256;
+
+/// Global storage for function parameters and the return value.
+extern SymExpr g_return_value;
+extern std::array<SymExpr, kMaxFunctionArguments> g_function_arguments;
+// TODO make thread-local
+
+/// Read the expression for a memory region that may be symbolic; this is
+/// _sym_read_memory after its fast path.
+SymExpr readSymbolicMemory(uint8_t *addr, size_t length, bool little_endian);
+
+/// Write the expression for a memory region; this is _sym_write_memory after
+/// its fast path.
+void writeSymbolicMemory(uint8_t *addr, size_t length, SymExpr expr,
+                         bool little_endian);
+
+#endif
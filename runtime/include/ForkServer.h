@@ -0,0 +1,52 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef FORKSERVER_H
+#define FORKSERVER_H
+
+#include <cstddef>
+#include <cstdio>
+
+/// The file descriptor on which the fork server receives requests.
+constexpr int kForkServerControlFd = 198;
+
+/// The file descriptor on which the fork server reports to its client.
+constexpr int kForkServerStatusFd = 199;
+
+/// Start the fork server if it is enabled in the configuration.
+///
+/// By default, the libc wrappers call this right before the program reads its
+/// symbolic input for the first time, i.e., after all input-independent
+/// initialization. The protocol is the same as AFL's: we announce ourselves
+/// with a 4-byte message on the status descriptor, then wait for 4-byte
+/// requests on the control descriptor. For each request, we fork a child,
+/// report its PID, wait for it, and report its status as returned by waitpid.
+/// The function only returns in the children (which go on to read the input
+/// and execute the rest of the program), or if nobody is listening on the
+/// status descriptor. When the client closes the control descriptor, the
+/// server exits.
+///
+/// The server may also start later, after the program has consumed part of
+/// the input (see symcc_snapshot and SYMCC_SNAPSHOT_OFFSET); the children then
+/// inherit the shadow memory, expressions and path constraints of the prefix.
+/// The announcement contains the length of the prefix, so that the client can
+/// tell which inputs share it. In the children, the input file descriptor (if
+/// valid) is reset to the position of the snapshot, and the input stream's
+/// read-ahead buffer is discarded beforehand; the client provides each new
+/// input by rewriting the file.
+void maybeRunForkServer(int inputFileDescriptor, FILE *inputStream,
+                        size_t inputOffset);
+
+#endif
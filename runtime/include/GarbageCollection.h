@@ -29,6 +29,9 @@ using ExpressionRegion = std::pair<SymExpr *, size_t>;
 /// expressions.
 void registerExpressionRegion(ExpressionRegion r);
 
+/// Overwrite all registered regions with null (i.e., concrete) expressions.
+void clearExpressionRegions();
+
 /// Return the set of currently reachable symbolic expressions.
 std::set<SymExpr> collectReachableExpressions();
 
@@ -22,4 +22,14 @@
 /// to symbolic input.
 void initLibcWrappers();
 
+/// Forget the position in the symbolic input.
+///
+/// This prepares the wrappers for the next iteration of a persistent loop: the
+/// program is expected to read the next input from the start (and to reopen the
+/// input file, if any).
+void resetLibcWrappers();
+
+/// Start the fork server at the current position in the symbolic input.
+void snapshotInput();
+
 #endif
@@ -0,0 +1,113 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef QUERYSCHEDULER_H
+#define QUERYSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <unordered_map>
+
+/// The result of trying to negate a branch condition.
+enum class QueryOutcome {
+  /// We found a diverging input.
+  Sat,
+  /// There is no diverging input.
+  Unsat,
+  /// The solver gave up (e.g., because of a timeout).
+  Unknown,
+  /// The backend didn't produce a new input; we don't know why.
+  Failed,
+};
+
+/// Per-site bookkeeping for solver queries.
+///
+/// Some program locations (think of a parser's loop over input bytes) produce
+/// thousands of queries, most of which don't lead anywhere. The scheduler keeps
+/// statistics for each site ID and, if enabled, backs off exponentially from
+/// sites that keep failing: after a few consecutive failures, it skips 1, 2, 4,
+/// ... queries before trying again. A successful query resets the backoff.
+///
+/// The scheduler also manages the time budget for solving: it computes a
+/// timeout for each query, and it stops all solving once the (optional) global
+/// deadline has passed, so that the program can run to completion concretely
+/// instead of being killed in the middle of a hopeless query.
+class QueryScheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Should we query the solver for the branch at the given site?
+  ///
+  /// Skipped queries are accounted for in the statistics.
+  bool shouldSolve(uintptr_t siteId);
+
+  /// Compute the solver timeout (in milliseconds) for the next query.
+  ///
+  /// Queries on short paths are usually easy, so they get a fraction of the
+  /// configured timeout that grows with the number of path constraints. The
+  /// result never exceeds the time left until the deadline.
+  unsigned queryTimeout(size_t pathLength) const;
+
+  /// Record the result of a query.
+  void recordQuery(uintptr_t siteId, QueryOutcome outcome,
+                   Clock::duration time);
+
+  /// Print the per-site statistics, most expensive sites first.
+  void report(std::ostream &out) const;
+
+  /// Start counting down to the solving deadline (if configured) from now.
+  void restartDeadline();
+
+private:
+  struct SiteStats {
+    size_t queries = 0;
+    size_t skipped = 0;
+    size_t sat = 0;
+    size_t unsat = 0;
+    size_t unknown = 0;
+    Clock::duration time{};
+
+    /// The number of failed queries since the last success.
+    size_t consecutiveFailures = 0;
+
+    /// The number of queries to skip before trying again.
+    size_t backoff = 0;
+  };
+
+  /// Has the global deadline passed?
+  bool deadlineExpired();
+
+  std::unordered_map<uintptr_t, SiteStats> sites;
+
+  /// The point in time after which we don't query the solver anymore.
+  std::optional<Clock::time_point> deadline;
+
+  /// Set once we've given up on solving because of the deadline.
+  bool outOfTime = false;
+};
+
+/// The global scheduler, used by all backends.
+extern QueryScheduler g_query_scheduler;
+
+/// Set up the scheduler according to the configuration.
+///
+/// In particular, this arranges for the per-site report to be written at exit
+/// if requested.
+void initQueryScheduler();
+
+#endif
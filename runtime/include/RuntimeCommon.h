@@ -46,6 +46,14 @@ extern "C" {
  */
 void _sym_initialize(void);
 
+/*
+ * Set as soon as the program obtains its first symbolic input byte. Before
+ * that, there are no symbolic expressions at all, so instrumented code can skip
+ * expression handling entirely, and backends don't need to be fully
+ * initialized.
+ */
+extern bool _sym_symbolic_mode;
+
 /*
  * Construction of simple values
  */
@@ -180,6 +188,15 @@ SymExpr _sym_get_return_expression(void);
  */
 void _sym_push_path_constraint(nullable SymExpr constraint, int taken,
                                uintptr_t site_id);
+/*
+ * A switch over expr, a bit vector of at most 64 bits, with the given
+ * (zero-extended) case values. The program took the case at taken_index, or
+ * the default if taken_index is num_cases. Backends may solve for all
+ * alternative cases at once.
+ */
+void _sym_push_switch_constraint(nullable SymExpr expr,
+                                 const uint64_t *case_values, size_t num_cases,
+                                 size_t taken_index, uintptr_t site_id);
 SymExpr _sym_get_input_byte(size_t offset, uint8_t concrete_value);
 void _sym_make_symbolic(const void *data, size_t byte_length,
                         size_t input_offset);
@@ -199,6 +216,25 @@ SymExpr _sym_build_insert(SymExpr target, SymExpr to_insert, uint64_t offset,
 SymExpr _sym_build_extract(SymExpr expr, uint64_t offset, uint64_t length,
                            bool little_endian);
 
+/*
+ * The shadow page table, for concreteness checks in instrumented code. The
+ * shadow expression of the byte at an address a below 2^SYM_SHADOW_ADDRESS_BITS
+ * is
+ *
+ *   _sym_shadow_table[a >> 29][(a >> 12) & 0x1ffff][a & 0xfff]
+ *
+ * where a null pointer on either of the first two levels means that the
+ * corresponding memory is concrete. Higher addresses, if any, are shadowed only
+ * in the run-time library's internal data structures.
+ */
+#define SYM_SHADOW_PAGE_BITS 12
+#define SYM_SHADOW_LEAF_BITS 17
+#define SYM_SHADOW_ADDRESS_BITS (sizeof(void *) == 8 ? 47 : 32)
+#define SYM_SHADOW_DIRECTORY_SIZE                                              \
+  ((size_t)1 << (SYM_SHADOW_ADDRESS_BITS - SYM_SHADOW_LEAF_BITS -             \
+                 SYM_SHADOW_PAGE_BITS))
+extern SymExpr **_sym_shadow_table[SYM_SHADOW_DIRECTORY_SIZE];
+
 /*
  * Call-stack tracing
  */
@@ -218,6 +254,15 @@ bool _sym_feasible(SymExpr expr);
 void _sym_register_expression_region(SymExpr *start, size_t length);
 void _sym_collect_garbage(void);
 
+/*
+ * Persistent mode
+ *
+ * Between iterations of symcc_persistent_loop, the backend forgets everything
+ * about the previous execution (expressions, path constraints and input) but
+ * keeps caches that are independent of the input.
+ */
+void _sym_reset_backend(void);
+
 /*
  * User-facing functionality
  *
@@ -228,6 +273,24 @@ void symcc_make_symbolic(const void *start, size_t byte_length);
 typedef void (*TestCaseHandler)(const void *, size_t);
 void symcc_set_test_case_handler(TestCaseHandler handler);
 
+/*
+ * Use as "while (symcc_persistent_loop(n)) { ... }" to analyze up to n inputs
+ * in one process, like AFL's __AFL_LOOP. Each call after the first resets the
+ * symbolic state of the run-time library, so the loop body must obtain fresh
+ * input and must not carry data derived from the input across iterations.
+ */
+int symcc_persistent_loop(unsigned int max_iterations);
+
+/*
+ * Start the fork server (if enabled) at this point of the execution.
+ *
+ * Without a call to this function, the fork server starts when the program
+ * first reads its input at or after SYMCC_SNAPSHOT_OFFSET. Calling it after
+ * parsing a fixed header, for example, lets every execution resume with the
+ * symbolic state of the header instead of recomputing it.
+ */
+void symcc_snapshot(void);
+
 #ifdef __cplusplus
 }
 #endif
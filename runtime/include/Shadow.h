@@ -51,10 +51,40 @@ constexpr uintptr_t pageOffset(uintptr_t addr) {
   return (addr & (kPageSize - 1));
 }
 
+static_assert(kPageSize == (1 << SYM_SHADOW_PAGE_BITS),
+              "The shadow page table must use our page size");
+
 /// A mapping from page addresses to the corresponding shadow regions. Each
 /// shadow is large enough to hold one expression per byte on the shadowed page.
+///
+/// For most of the address space, the shadow page table (_sym_shadow_table)
+/// holds the same information in a form that is faster to query.
 extern std::map<uintptr_t, SymExpr *> g_shadow_pages;
 
+/// Is the address covered by the shadow page table?
+constexpr bool inShadowTable(uintptr_t addr) {
+  return (static_cast<uint64_t>(addr) >> SYM_SHADOW_ADDRESS_BITS) == 0;
+}
+
+/// Find the shadow of the page containing the address in the shadow page
+/// table, or return null if the page is concrete. The address must be covered
+/// by the table.
+inline SymExpr *lookupShadowTable(uintptr_t addr) {
+  auto *leaf =
+      _sym_shadow_table[addr >> (SYM_SHADOW_LEAF_BITS + SYM_SHADOW_PAGE_BITS)];
+  if (leaf == nullptr)
+    return nullptr;
+
+  return leaf[(addr >> SYM_SHADOW_PAGE_BITS) &
+              ((1 << SYM_SHADOW_LEAF_BITS) - 1)];
+}
+
+/// Allocate and register an empty shadow for the page containing the address.
+SymExpr *createShadow(uintptr_t addr);
+
+/// Release all shadow pages, making the entire memory concrete.
+void clearShadowMemory();
+
 /// An iterator that walks over the shadow bytes corresponding to a memory
 /// region. If there is no shadow for any given memory address, it just returns
 /// null.
@@ -109,6 +139,11 @@ public:
 
 protected:
   static SymExpr *getShadow(uintptr_t address) {
+    if (inShadowTable(address)) {
+      auto *shadowPage = lookupShadowTable(address);
+      return shadowPage != nullptr ? shadowPage + pageOffset(address) : nullptr;
+    }
+
     if (auto shadowPageIt = g_shadow_pages.find(pageStart(address));
         shadowPageIt != g_shadow_pages.end())
       return shadowPageIt->second + pageOffset(address);
@@ -167,11 +202,7 @@ protected:
     if (auto *shadow = getShadow(address))
       return shadow;
 
-    auto *newShadow =
-        static_cast<SymExpr *>(malloc(kPageSize * sizeof(SymExpr)));
-    memset(newShadow, 0, kPageSize * sizeof(SymExpr));
-    g_shadow_pages[pageStart(address)] = newShadow;
-    return newShadow + pageOffset(address);
+    return createShadow(address) + pageOffset(address);
   }
 };
 
@@ -210,13 +241,17 @@ template <typename T> struct ReadWriteShadow {
   size_t length_;
 };
 
+/// Check quickly whether a memory range within a single page is concrete
+/// because the page doesn't have a shadow. A negative answer is inconclusive.
+inline bool isConcreteWithinPage(uintptr_t addr, size_t nbytes) {
+  return pageStart(addr) == pageStart(addr + nbytes - 1) &&
+         inShadowTable(addr) && lookupShadowTable(addr) == nullptr;
+}
+
 /// Check whether the indicated memory range is concrete, i.e., there is no
 /// symbolic byte in the entire region.
 template <typename T> bool isConcrete(T *addr, size_t nbytes) {
-  // Fast path for allocations within one page.
-  auto byteBuf = reinterpret_cast<uintptr_t>(addr);
-  if (pageStart(byteBuf) == pageStart(byteBuf + nbytes) &&
-      !g_shadow_pages.count(pageStart(byteBuf)))
+  if (isConcreteWithinPage(reinterpret_cast<uintptr_t>(addr), nbytes))
     return true;
 
   ReadOnlyShadow shadow(addr, nbytes);
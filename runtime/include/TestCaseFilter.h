@@ -0,0 +1,36 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef TESTCASEFILTER_H
+#define TESTCASEFILTER_H
+
+#include <cstdint>
+#include <vector>
+
+/// Decide whether a newly generated input should be emitted.
+///
+/// Different branches often solve to the same bytes, and every duplicate would
+/// otherwise be written to disk, copied by the fuzzing helper and run through
+/// AFL's coverage check. We remember a 64-bit hash of each input that we emit
+/// and return false for inputs whose hash we have seen before. A hash collision
+/// would suppress a genuinely new input, but that is extremely unlikely for
+/// realistic numbers of test cases.
+///
+/// If SYMCC_DEDUPLICATE_ACROSS_RUNS is set, the hashes are also appended to a
+/// file in the output directory, and hashes written by other executions
+/// (including concurrent ones) are taken into account.
+bool isNewTestCase(const std::vector<uint8_t> &input);
+
+#endif
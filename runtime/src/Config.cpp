@@ -38,6 +38,25 @@ bool checkFlagString(std::string value) {
   throw std::runtime_error(msg.str());
 }
 
+unsigned checkUnsignedString(const std::string &value,
+                             const std::string &description) {
+  try {
+    auto result = std::stoul(value);
+    if (result > std::numeric_limits<unsigned>::max())
+      throw std::out_of_range(value);
+    return result;
+  } catch (std::invalid_argument &) {
+    std::stringstream msg;
+    msg << "Can't convert " << value << " to an integer";
+    throw std::runtime_error(msg.str());
+  } catch (std::out_of_range &) {
+    std::stringstream msg;
+    msg << "The " << description << " must be between 0 and "
+        << std::numeric_limits<unsigned>::max();
+    throw std::runtime_error(msg.str());
+  }
+}
+
 } // namespace
 
 Config g_config;
@@ -47,6 +66,10 @@ void loadConfig() {
   if (outputDir != nullptr)
     g_config.outputDir = outputDir;
 
+  auto *deduplicateAcrossRuns = getenv("SYMCC_DEDUPLICATE_ACROSS_RUNS");
+  if (deduplicateAcrossRuns != nullptr)
+    g_config.deduplicateAcrossRuns = checkFlagString(deduplicateAcrossRuns);
+
   auto *inputFile = getenv("SYMCC_INPUT_FILE");
   if (inputFile != nullptr)
     g_config.input = FileInput{inputFile};
@@ -76,6 +99,65 @@ void loadConfig() {
   if (aflCoverageMap != nullptr)
     g_config.aflCoverageMap = aflCoverageMap;
 
+  auto *aflCoverageShm = getenv("SYMCC_AFL_COVERAGE_SHM");
+  if (aflCoverageShm != nullptr) {
+    if (!g_config.aflCoverageMap.empty())
+      throw std::runtime_error{"Can't use a coverage map file and a shared-"
+                               "memory coverage map at the same time"};
+
+    g_config.aflCoverageShm = aflCoverageShm;
+  }
+
+  auto *modelCache = getenv("SYMCC_ENABLE_MODEL_CACHE");
+  if (modelCache != nullptr)
+    g_config.modelCache = checkFlagString(modelCache);
+
+  auto *siteBackoff = getenv("SYMCC_SITE_BACKOFF");
+  if (siteBackoff != nullptr)
+    g_config.siteBackoff = checkFlagString(siteBackoff);
+
+  auto *queryStatsFile = getenv("SYMCC_QUERY_STATS_FILE");
+  if (queryStatsFile != nullptr)
+    g_config.queryStatsFile = queryStatsFile;
+
+  auto *queryTimeout = getenv("SYMCC_QUERY_TIMEOUT");
+  if (queryTimeout != nullptr)
+    g_config.queryTimeout = checkUnsignedString(queryTimeout, "query timeout");
+
+  auto *solvingDeadline = getenv("SYMCC_SOLVING_DEADLINE");
+  if (solvingDeadline != nullptr)
+    g_config.solvingDeadline =
+        checkUnsignedString(solvingDeadline, "solving deadline");
+
+  auto *forkServer = getenv("SYMCC_FORK_SERVER");
+  if (forkServer != nullptr)
+    g_config.forkServer = checkFlagString(forkServer);
+
+  auto *snapshotOffset = getenv("SYMCC_SNAPSHOT_OFFSET");
+  if (snapshotOffset != nullptr)
+    g_config.snapshotOffset =
+        checkUnsignedString(snapshotOffset, "snapshot offset");
+
+  auto *exploreWorkers = getenv("SYMCC_EXPLORE_WORKERS");
+  if (exploreWorkers != nullptr) {
+    if (g_config.forkServer)
+      throw std::runtime_error{
+          "Can't enable the fork server and exploration at the same time"};
+
+    g_config.exploreWorkers =
+        checkUnsignedString(exploreWorkers, "number of exploration workers");
+  }
+
+  auto *exploreLimit = getenv("SYMCC_EXPLORE_LIMIT");
+  if (exploreLimit != nullptr)
+    g_config.exploreLimit =
+        checkUnsignedString(exploreLimit, "exploration limit");
+
+  auto *exploreTimeout = getenv("SYMCC_EXPLORE_TIMEOUT");
+  if (exploreTimeout != nullptr)
+    g_config.exploreTimeout =
+        checkUnsignedString(exploreTimeout, "exploration timeout");
+
   auto *garbageCollectionThreshold = getenv("SYMCC_GC_THRESHOLD");
   if (garbageCollectionThreshold != nullptr) {
     try {
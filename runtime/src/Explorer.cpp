@@ -0,0 +1,303 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#include "Explorer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Config.h"
+#include "QueryScheduler.h"
+
+namespace {
+
+using Input = std::vector<uint8_t>;
+using Clock = std::chrono::steady_clock;
+
+/// How long children may run past the solving deadline before we kill them.
+constexpr auto kDeadlineGracePeriod = std::chrono::seconds(10);
+
+/// How long children may run if there is no solving deadline.
+constexpr auto kDefaultChildTimeout = std::chrono::seconds(90);
+
+/// A running child process.
+struct Worker {
+  pid_t pid;
+
+  /// The pipe on which the child reports new inputs.
+  int reportPipe;
+
+  Clock::time_point start;
+
+  /// Have we killed the child for running too long?
+  bool killed = false;
+};
+
+/// Have we already reached the fork point?
+bool g_explorer_started = false;
+
+/// In a child, the pipe on which we report new inputs to the parent.
+int g_report_fd = -1;
+
+/// In a child, the input that the program should read instead of the original
+/// one (if any).
+std::optional<Input> g_replacement_input;
+
+/// In a child, the path of the in-memory file containing the replacement
+/// input.
+std::string g_replacement_path;
+
+[[noreturn]] void fail(const char *what) {
+  std::cerr << "Error: the explorer failed to " << what << ": "
+            << strerror(errno) << std::endl;
+  _exit(-1);
+}
+
+bool writeAll(int fd, const void *data, size_t length) {
+  auto *bytes = static_cast<const uint8_t *>(data);
+  while (length > 0) {
+    auto written = write(fd, bytes, length);
+    if (written == -1 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    bytes += written;
+    length -= written;
+  }
+
+  return true;
+}
+
+/// Read exactly the requested number of bytes; return false on end of file.
+bool readAll(int fd, void *data, size_t length) {
+  auto *bytes = static_cast<uint8_t *>(data);
+  while (length > 0) {
+    auto bytesRead = read(fd, bytes, length);
+    if (bytesRead == -1 && errno == EINTR)
+      continue;
+    if (bytesRead <= 0)
+      return false;
+    bytes += bytesRead;
+    length -= bytesRead;
+  }
+
+  return true;
+}
+
+/// Set up a freshly forked child to run on the given input.
+void startChild(int reportPipe, std::optional<Input> input,
+                int inputFileDescriptor) {
+  g_report_fd = reportPipe;
+  g_query_scheduler.restartDeadline();
+
+  // The first child runs on the original input.
+  if (!input.has_value())
+    return;
+
+  int inputFd = memfd_create("symcc-input", 0);
+  if (inputFd == -1 || !writeAll(inputFd, input->data(), input->size()))
+    fail("create the input file");
+  lseek(inputFd, 0, SEEK_SET);
+
+  if (inputFileDescriptor != -1) {
+    if (dup2(inputFd, inputFileDescriptor) == -1)
+      fail("replace the input");
+    lseek(inputFileDescriptor, 0, SEEK_SET);
+  }
+
+  g_replacement_path = "/proc/self/fd/" + std::to_string(inputFd);
+  g_replacement_input = std::move(input);
+}
+
+/// The time after which we kill a child (see SYMCC_EXPLORE_TIMEOUT).
+Clock::duration childTimeout() {
+  if (g_config.exploreTimeout > 0)
+    return std::chrono::seconds(g_config.exploreTimeout);
+  if (g_config.solvingDeadline > 0)
+    return std::chrono::seconds(g_config.solvingDeadline) +
+           kDeadlineGracePeriod;
+  return kDefaultChildTimeout;
+}
+
+/// Run the exploration loop; return only in the children.
+void explore(int inputFileDescriptor) {
+  auto timeout = childTimeout();
+  std::deque<Input> pending;
+  std::unordered_set<size_t> seen;
+  std::vector<Worker> workers;
+  size_t executions = 0;
+
+  // Anything that is still buffered would be written by every child.
+  fflush(nullptr);
+
+  while (executions == 0 || !pending.empty() || !workers.empty()) {
+    while (workers.size() < g_config.exploreWorkers &&
+           (executions == 0 ||
+            (!pending.empty() && executions < g_config.exploreLimit))) {
+      std::optional<Input> input;
+      if (executions > 0) {
+        input = std::move(pending.front());
+        pending.pop_front();
+      }
+
+      int fds[2];
+      if (pipe2(fds, O_CLOEXEC) == -1)
+        fail("create a pipe");
+
+      auto child = fork();
+      if (child == -1)
+        fail("fork");
+
+      if (child == 0) {
+        close(fds[0]);
+        for (auto &worker : workers)
+          close(worker.reportPipe);
+        startChild(fds[1], std::move(input), inputFileDescriptor);
+        return;
+      }
+
+      close(fds[1]);
+      workers.push_back({child, fds[0], Clock::now()});
+      executions++;
+    }
+
+    if (workers.empty())
+      break; // We've reached the execution limit.
+
+    // Wake up when the next child times out; killed children close their
+    // pipes, so we reap them like the others.
+    auto now = Clock::now();
+    auto wakeUp = Clock::time_point::max();
+    for (auto &worker : workers) {
+      if (!worker.killed)
+        wakeUp = std::min(wakeUp, worker.start + timeout);
+    }
+
+    int pollTimeout = -1;
+    if (wakeUp != Clock::time_point::max()) {
+      auto delay = std::chrono::ceil<std::chrono::milliseconds>(wakeUp - now);
+      pollTimeout = std::clamp<std::chrono::milliseconds::rep>(
+          delay.count(), 0, std::numeric_limits<int>::max());
+    }
+
+    std::vector<pollfd> pollFds;
+    for (auto &worker : workers)
+      pollFds.push_back({worker.reportPipe, POLLIN, 0});
+    if (poll(pollFds.data(), pollFds.size(), pollTimeout) == -1) {
+      if (errno == EINTR)
+        continue;
+      fail("wait for the children");
+    }
+
+    now = Clock::now();
+    for (auto &worker : workers) {
+      if (!worker.killed && now - worker.start >= timeout) {
+        std::cerr << "Killing exploration child " << worker.pid
+                  << " because it exceeded the time limit" << std::endl;
+        kill(worker.pid, SIGKILL);
+        worker.killed = true;
+      }
+    }
+
+    std::vector<Worker> running;
+    for (size_t i = 0; i < workers.size(); i++) {
+      auto &worker = workers[i];
+      if (pollFds[i].revents == 0) {
+        running.push_back(worker);
+        continue;
+      }
+
+      uint64_t length;
+      Input input;
+      if (readAll(worker.reportPipe, &length, sizeof(length))) {
+        input.resize(length);
+        if (readAll(worker.reportPipe, input.data(), length)) {
+          auto hash = std::hash<std::string_view>{}(
+              {reinterpret_cast<const char *>(input.data()), input.size()});
+          if (seen.insert(hash).second)
+            pending.push_back(std::move(input));
+          running.push_back(worker);
+          continue;
+        }
+      }
+
+      // The child has closed the pipe, so it's about to exit.
+      close(worker.reportPipe);
+      waitpid(worker.pid, nullptr, 0);
+    }
+    workers = std::move(running);
+  }
+
+  std::cerr << "Exploration finished after " << executions << " executions ("
+            << pending.size() << " inputs left unexplored)" << std::endl;
+  _exit(0);
+}
+
+} // namespace
+
+void maybeRunExplorer(int inputFileDescriptor) {
+  if (g_config.exploreWorkers == 0 || g_explorer_started)
+    return;
+  g_explorer_started = true;
+
+  explore(inputFileDescriptor);
+}
+
+const char *replacementInputPath() {
+  return g_replacement_input.has_value() ? g_replacement_path.c_str()
+                                         : nullptr;
+}
+
+void patchMemoryInput(void *data, size_t length, size_t inputOffset) {
+  if (!g_replacement_input.has_value() ||
+      inputOffset >= g_replacement_input->size())
+    return;
+
+  auto available = g_replacement_input->size() - inputOffset;
+  memcpy(data, g_replacement_input->data() + inputOffset,
+         std::min(length, available));
+}
+
+void reportNewInput(const std::vector<uint8_t> &input) {
+  if (g_report_fd == -1)
+    return;
+
+  uint64_t length = input.size();
+  if (!writeAll(g_report_fd, &length, sizeof(length)) ||
+      !writeAll(g_report_fd, input.data(), input.size())) {
+    std::cerr << "Warning: failed to report a new input to the explorer"
+              << std::endl;
+    close(g_report_fd);
+    g_report_fd = -1;
+  }
+}
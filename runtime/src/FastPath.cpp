@@ -0,0 +1,68 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+//
+// Run-time functions that instrumented code calls very often, but which do
+// hardly any work in the common case. In addition to being part of the
+// library, this file is compiled to LLVM bitcode that symcc links into programs
+// built with LTO, so that the fast paths can be inlined (see
+// docs/Optimization.txt). Therefore, the code here must not define any state of
+// its own, and it must not need anything from the C++ standard library at link
+// time.
+//
+
+#include <cassert>
+
+#include "FastPath.h"
+#include "Shadow.h"
+
+void _sym_set_return_expression(SymExpr expr) { g_return_value = expr; }
+
+SymExpr _sym_get_return_expression(void) {
+  auto *result = g_return_value;
+  // TODO this is a safeguard that can eventually be removed
+  g_return_value = nullptr;
+  return result;
+}
+
+void _sym_set_parameter_expression(uint8_t index, SymExpr expr) {
+  g_function_arguments[index] = expr;
+}
+
+SymExpr _sym_get_parameter_expression(uint8_t index) {
+  return g_function_arguments[index];
+}
+
+SymExpr _sym_read_memory(uint8_t *addr, size_t length, bool little_endian) {
+  assert(length && "Invalid query for zero-length memory region");
+
+  if (!_sym_symbolic_mode ||
+      isConcreteWithinPage(reinterpret_cast<uintptr_t>(addr), length))
+    return nullptr;
+
+  return readSymbolicMemory(addr, length, little_endian);
+}
+
+void _sym_write_memory(uint8_t *addr, size_t length, SymExpr expr,
+                       bool little_endian) {
+  assert(length && "Invalid query for zero-length memory region");
+
+  if (!_sym_symbolic_mode ||
+      (expr == nullptr &&
+       isConcreteWithinPage(reinterpret_cast<uintptr_t>(addr), length)))
+    return;
+
+  writeSymbolicMemory(addr, length, expr, little_endian);
+}
@@ -0,0 +1,104 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#include "ForkServer.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Config.h"
+#include "QueryScheduler.h"
+
+namespace {
+
+/// Have we already reached the fork point?
+bool g_fork_server_started = false;
+
+bool sendMessage(uint32_t message) {
+  return write(kForkServerStatusFd, &message, sizeof(message)) ==
+         sizeof(message);
+}
+
+[[noreturn]] void fail(const char *what) {
+  std::cerr << "Error: the fork server failed to " << what << ": "
+            << strerror(errno) << std::endl;
+  _exit(-1);
+}
+
+} // namespace
+
+void maybeRunForkServer(int inputFileDescriptor, FILE *inputStream,
+                        size_t inputOffset) {
+  if (!g_config.forkServer || g_fork_server_started)
+    return;
+  g_fork_server_started = true;
+
+  if (!sendMessage(inputOffset)) {
+    std::cerr << "Warning: no fork-server client is listening; running the "
+                 "program normally"
+              << std::endl;
+    return;
+  }
+
+  // Anything that is still buffered would be written by every child. On input
+  // streams, flushing discards the read-ahead and moves the file position back
+  // to what the program has actually consumed.
+  if (inputStream != nullptr)
+    fflush(inputStream);
+  fflush(nullptr);
+
+  off_t snapshotPosition = -1;
+  if (inputFileDescriptor != -1)
+    snapshotPosition = lseek(inputFileDescriptor, 0, SEEK_CUR);
+
+  while (true) {
+    uint32_t request;
+    auto bytesRead = read(kForkServerControlFd, &request, sizeof(request));
+    if (bytesRead == 0)
+      _exit(0); // The client is gone.
+    if (bytesRead != sizeof(request))
+      fail("receive a request");
+
+    auto child = fork();
+    if (child == -1)
+      fail("fork");
+
+    if (child == 0) {
+      close(kForkServerControlFd);
+      close(kForkServerStatusFd);
+      if (snapshotPosition != -1)
+        lseek(inputFileDescriptor, snapshotPosition, SEEK_SET);
+
+      // The solving deadline applies to each execution separately.
+      g_query_scheduler.restartDeadline();
+      return;
+    }
+
+    if (!sendMessage(child))
+      fail("report the child's PID");
+
+    int status;
+    if (waitpid(child, &status, 0) == -1)
+      fail("wait for the child");
+    if (!sendMessage(status))
+      fail("report the child's status");
+  }
+}
@@ -15,6 +15,7 @@
 
 #include "GarbageCollection.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <Runtime.h>
@@ -27,6 +28,11 @@ void registerExpressionRegion(ExpressionRegion r) {
   expressionRegions.push_back(std::move(r));
 }
 
+void clearExpressionRegions() {
+  for (auto &[start, length] : expressionRegions)
+    std::fill(start, start + length, nullptr);
+}
+
 std::set<SymExpr> collectReachableExpressions() {
   std::set<SymExpr> reachableExpressions;
   auto collectReachableExpressions = [&](ExpressionRegion r) {
@@ -45,6 +45,8 @@
 #include <unistd.h>
 
 #include "Config.h"
+#include "Explorer.h"
+#include "ForkServer.h"
 #include "Shadow.h"
 #include <Runtime.h>
 
@@ -55,6 +57,9 @@ namespace {
 /// The file descriptor referring to the symbolic input.
 int inputFileDescriptor = -1;
 
+/// The stream referring to the symbolic input, if the program uses stdio.
+FILE *inputStream = nullptr;
+
 /// The current position in the (symbolic) input.
 uint64_t inputOffset = 0;
 
@@ -75,12 +80,14 @@ void tryAlternative(E *value, SymExpr valueExpr, F caller) {
   tryAlternative(reinterpret_cast<intptr_t>(value), valueExpr, caller);
 }
 
-void maybeSetInputFile(const char *path, int fd) {
+bool isInputFile(const char *path) {
   auto *fileInput = std::get_if<FileInput>(&g_config.input);
-  if (fileInput == nullptr)
-    return;
+  return fileInput != nullptr &&
+         strstr(path, fileInput->fileName.c_str()) != nullptr;
+}
 
-  if (strstr(path, fileInput->fileName.c_str()) == nullptr)
+void maybeSetInputFile(const char *path, int fd, FILE *stream = nullptr) {
+  if (!isInputFile(path))
     return;
 
   if (inputFileDescriptor != -1)
@@ -89,18 +96,59 @@ void maybeSetInputFile(const char *path, int fd) {
               << std::endl;
 
   inputFileDescriptor = fd;
+  inputStream = stream;
   inputOffset = 0;
 }
 
+/// Give the fork server or the explorer a chance to start before the program
+/// opens the input file, so that each child opens it anew.
+///
+/// Return the path that the program should open instead.
+const char *maybeForkBeforeOpen(const char *path) {
+  if (!isInputFile(path))
+    return path;
+
+  if (g_config.snapshotOffset == 0)
+    maybeRunForkServer(-1, nullptr, 0);
+  maybeRunExplorer(-1);
+
+  auto *replacement = replacementInputPath();
+  return (replacement != nullptr) ? replacement : path;
+}
+
+/// Give the fork server or the explorer a chance to start before the program
+/// reads from the given file descriptor for the first time (or, in the case of
+/// the fork server, before it reads past the configured snapshot offset).
+void maybeForkBeforeRead(int fd) {
+  if (fd != -1 && fd == inputFileDescriptor) {
+    if (inputOffset >= g_config.snapshotOffset)
+      maybeRunForkServer(fd, inputStream, inputOffset);
+    maybeRunExplorer(fd);
+  }
+}
+
 } // namespace
 
 void initLibcWrappers() {
   if (std::holds_alternative<StdinInput>(g_config.input)) {
     // Symbolic data comes from standard input.
     inputFileDescriptor = 0;
+    inputStream = stdin;
+  }
+}
+
+void resetLibcWrappers() {
+  inputOffset = 0;
+  if (std::holds_alternative<FileInput>(g_config.input)) {
+    inputFileDescriptor = -1;
+    inputStream = nullptr;
   }
 }
 
+void snapshotInput() {
+  maybeRunForkServer(inputFileDescriptor, inputStream, inputOffset);
+}
+
 extern "C" {
 
 void *SYM(malloc)(size_t size) {
@@ -127,6 +175,7 @@ void *SYM(calloc)(size_t nmemb, size_t size) {
 
 void *SYM(mmap64)(void *addr, size_t len, int prot, int flags, int fildes,
                   uint64_t off) {
+  maybeForkBeforeRead(fildes);
   auto *result = mmap64(addr, len, prot, flags, fildes, off);
   _sym_set_return_expression(nullptr);
 
@@ -162,7 +211,7 @@ void *SYM(mmap)(void *addr, size_t len, int prot, int flags, int fildes,
 }
 
 int SYM(open)(const char *path, int oflag, mode_t mode) {
-  auto result = open(path, oflag, mode);
+  auto result = open(maybeForkBeforeOpen(path), oflag, mode);
   _sym_set_return_expression(nullptr);
 
   if (result >= 0)
@@ -175,6 +224,7 @@ ssize_t SYM(read)(int fildes, void *buf, size_t nbyte) {
   tryAlternative(buf, _sym_get_parameter_expression(1), SYM(read));
   tryAlternative(nbyte, _sym_get_parameter_expression(2), SYM(read));
 
+  maybeForkBeforeRead(fildes);
   auto result = read(fildes, buf, nbyte);
   _sym_set_return_expression(nullptr);
 
@@ -236,21 +286,21 @@ uint32_t SYM(lseek)(int fd, uint32_t offset, int whence) {
 }
 
 FILE *SYM(fopen)(const char *pathname, const char *mode) {
-  auto *result = fopen(pathname, mode);
+  auto *result = fopen(maybeForkBeforeOpen(pathname), mode);
   _sym_set_return_expression(nullptr);
 
   if (result != nullptr)
-    maybeSetInputFile(pathname, fileno(result));
+    maybeSetInputFile(pathname, fileno(result), result);
 
   return result;
 }
 
 FILE *SYM(fopen64)(const char *pathname, const char *mode) {
-  auto *result = fopen64(pathname, mode);
+  auto *result = fopen64(maybeForkBeforeOpen(pathname), mode);
   _sym_set_return_expression(nullptr);
 
   if (result != nullptr)
-    maybeSetInputFile(pathname, fileno(result));
+    maybeSetInputFile(pathname, fileno(result), result);
 
   return result;
 }
@@ -260,6 +310,7 @@ size_t SYM(fread)(void *ptr, size_t size, size_t nmemb, FILE *stream) {
   tryAlternative(size, _sym_get_parameter_expression(1), SYM(fread));
   tryAlternative(nmemb, _sym_get_parameter_expression(2), SYM(fread));
 
+  maybeForkBeforeRead(fileno(stream));
   auto result = fread(ptr, size, nmemb, stream);
   _sym_set_return_expression(nullptr);
 
@@ -279,6 +330,7 @@ char *SYM(fgets)(char *str, int n, FILE *stream) {
   tryAlternative(str, _sym_get_parameter_expression(0), SYM(fgets));
   tryAlternative(n, _sym_get_parameter_expression(1), SYM(fgets));
 
+  maybeForkBeforeRead(fileno(stream));
   auto result = fgets(str, n, stream);
   _sym_set_return_expression(_sym_get_parameter_expression(0));
 
@@ -359,6 +411,7 @@ int SYM(fseeko64)(FILE *stream, uint64_t offset, int whence) {
 }
 
 int SYM(getc)(FILE *stream) {
+  maybeForkBeforeRead(fileno(stream));
   auto result = getc(stream);
   if (result == EOF) {
     _sym_set_return_expression(nullptr);
@@ -375,6 +428,7 @@ int SYM(getc)(FILE *stream) {
 }
 
 int SYM(fgetc)(FILE *stream) {
+  maybeForkBeforeRead(fileno(stream));
   auto result = fgetc(stream);
   if (result == EOF) {
     _sym_set_return_expression(nullptr);
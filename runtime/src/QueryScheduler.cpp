@@ -0,0 +1,162 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#include "QueryScheduler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Config.h"
+
+namespace {
+
+/// The number of consecutive failures that we tolerate before backing off.
+constexpr size_t kTolerance = 3;
+
+/// The maximum number of queries to skip in a row.
+constexpr size_t kMaxBackoff = 1024;
+
+/// The smallest timeout that we give a query (in milliseconds); we don't start
+/// new queries if there is less time than this left until the deadline.
+constexpr unsigned kMinQueryTimeout = 500;
+
+/// The additional time per path constraint that we give a query (in
+/// milliseconds).
+constexpr unsigned kTimeoutPerConstraint = 100;
+
+void writeReport() {
+  std::ofstream out(g_config.queryStatsFile);
+  if (!out) {
+    std::cerr << "Warning: can't write query statistics to "
+              << g_config.queryStatsFile << std::endl;
+    return;
+  }
+
+  g_query_scheduler.report(out);
+}
+
+} // namespace
+
+QueryScheduler g_query_scheduler;
+
+bool QueryScheduler::deadlineExpired() {
+  if (outOfTime)
+    return true;
+
+  if (!deadline.has_value() ||
+      *deadline - Clock::now() >=
+          std::chrono::milliseconds(kMinQueryTimeout))
+    return false;
+
+  std::cerr << "Reached the solving deadline; continuing without the solver"
+            << std::endl;
+  outOfTime = true;
+  return true;
+}
+
+bool QueryScheduler::shouldSolve(uintptr_t siteId) {
+  auto &site = sites[siteId];
+  if (deadlineExpired()) {
+    site.skipped++;
+    return false;
+  }
+
+  if (!g_config.siteBackoff || site.backoff == 0)
+    return true;
+
+  site.backoff--;
+  site.skipped++;
+  return false;
+}
+
+void QueryScheduler::recordQuery(uintptr_t siteId, QueryOutcome outcome,
+                                 Clock::duration time) {
+  auto &site = sites[siteId];
+  site.queries++;
+  site.time += time;
+
+  if (outcome == QueryOutcome::Sat) {
+    site.sat++;
+    site.consecutiveFailures = 0;
+    return;
+  }
+
+  if (outcome == QueryOutcome::Unsat)
+    site.unsat++;
+  else
+    site.unknown++;
+
+  site.consecutiveFailures++;
+  if (site.consecutiveFailures > kTolerance) {
+    auto exponent = std::min<size_t>(site.consecutiveFailures - kTolerance - 1,
+                                     10);
+    site.backoff = std::min(size_t(1) << exponent, kMaxBackoff);
+  }
+}
+
+unsigned QueryScheduler::queryTimeout(size_t pathLength) const {
+  auto timeout = std::min<uint64_t>(
+      g_config.queryTimeout,
+      kMinQueryTimeout + uint64_t(kTimeoutPerConstraint) * pathLength);
+
+  if (deadline.has_value()) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        *deadline - Clock::now());
+    timeout = std::min<uint64_t>(timeout,
+                                 std::max<int64_t>(remaining.count(), 1));
+  }
+
+  return timeout;
+}
+
+void QueryScheduler::report(std::ostream &out) const {
+  std::vector<std::pair<uintptr_t, SiteStats>> sorted(sites.begin(),
+                                                      sites.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+    return a.second.time > b.second.time;
+  });
+
+  out << std::left << std::setw(20) << "site" << std::right << std::setw(10)
+      << "queries" << std::setw(10) << "skipped" << std::setw(10) << "sat"
+      << std::setw(10) << "unsat" << std::setw(10) << "unknown"
+      << std::setw(12) << "time [ms]" << std::endl;
+
+  for (const auto &[siteId, site] : sorted) {
+    auto millis =
+        std::chrono::duration_cast<std::chrono::milliseconds>(site.time);
+    out << "0x" << std::left << std::setw(18) << std::hex << siteId
+        << std::dec << std::right << std::setw(10) << site.queries
+        << std::setw(10) << site.skipped << std::setw(10) << site.sat
+        << std::setw(10) << site.unsat << std::setw(10) << site.unknown
+        << std::setw(12) << millis.count() << std::endl;
+  }
+}
+
+void QueryScheduler::restartDeadline() {
+  if (g_config.solvingDeadline > 0)
+    deadline = Clock::now() + std::chrono::seconds(g_config.solvingDeadline);
+  outOfTime = false;
+}
+
+void initQueryScheduler() {
+  g_query_scheduler.restartDeadline();
+
+  if (!g_config.queryStatsFile.empty())
+    atexit(writeReport);
+}
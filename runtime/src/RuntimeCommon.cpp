@@ -24,18 +24,21 @@
 #include <variant>
 
 #include "Config.h"
+#include "Explorer.h"
+#include "FastPath.h"
 #include "GarbageCollection.h"
+#include "LibcWrappers.h"
+#include "QueryScheduler.h"
 #include "RuntimeCommon.h"
 #include "Shadow.h"
 
-namespace {
-
-constexpr int kMaxFunctionArguments = 256;
-
-/// Global storage for function parameters and the return value.
 SymExpr g_return_value;
 std::array<SymExpr, kMaxFunctionArguments> g_function_arguments;
-// TODO make thread-local
+
+namespace {
+
+/// The position in the input provided via symcc_make_symbolic.
+size_t g_memory_input_offset = 0;
 
 SymExpr buildMinSignedInt(uint8_t bits) {
   return _sym_build_integer((uint64_t)(1) << (bits - 1), bits);
@@ -84,25 +87,11 @@ SymExpr buildOverflowResult(SymExpr result_expr, SymExpr overflow,
 
 } // namespace
 
-void _sym_set_return_expression(SymExpr expr) { g_return_value = expr; }
-
-SymExpr _sym_get_return_expression(void) {
-  auto *result = g_return_value;
-  // TODO this is a safeguard that can eventually be removed
-  g_return_value = nullptr;
-  return result;
-}
-
-void _sym_set_parameter_expression(uint8_t index, SymExpr expr) {
-  g_function_arguments[index] = expr;
-}
-
-SymExpr _sym_get_parameter_expression(uint8_t index) {
-  return g_function_arguments[index];
-}
+bool _sym_symbolic_mode = false;
 
 void _sym_memcpy(uint8_t *dest, const uint8_t *src, size_t length) {
-  if (isConcrete(src, length) && isConcrete(dest, length))
+  if (!_sym_symbolic_mode ||
+      (isConcrete(src, length) && isConcrete(dest, length)))
     return;
 
   ReadOnlyShadow srcShadow(src, length);
@@ -111,7 +100,8 @@ void _sym_memcpy(uint8_t *dest, const uint8_t *src, size_t length) {
 }
 
 void _sym_memset(uint8_t *memory, SymExpr value, size_t length) {
-  if ((value == nullptr) && isConcrete(memory, length))
+  if (!_sym_symbolic_mode ||
+      ((value == nullptr) && isConcrete(memory, length)))
     return;
 
   ReadWriteShadow shadow(memory, length);
@@ -123,7 +113,8 @@ void _sym_memmove(uint8_t *dest, const uint8_t *src, size_t length) {
   // regions, we need to copy the symbolic expressions over. (In the case where
   // only the destination is symbolic, this means making it concrete.)
 
-  if (isConcrete(src, length) && isConcrete(dest, length))
+  if (!_sym_symbolic_mode ||
+      (isConcrete(src, length) && isConcrete(dest, length)))
     return;
 
   ReadOnlyShadow srcShadow(src, length);
@@ -134,17 +125,16 @@ void _sym_memmove(uint8_t *dest, const uint8_t *src, size_t length) {
     std::copy(srcShadow.begin(), srcShadow.end(), destShadow.begin());
 }
 
-SymExpr _sym_read_memory(uint8_t *addr, size_t length, bool little_endian) {
-  assert(length && "Invalid query for zero-length memory region");
-
+SymExpr readSymbolicMemory(uint8_t *addr, size_t length, bool little_endian) {
 #ifdef DEBUG_RUNTIME
   std::cerr << "Reading " << length << " bytes from address " << P(addr)
             << std::endl;
   dump_known_regions();
 #endif
 
-  // If the entire memory region is concrete, don't create a symbolic expression
-  // at all.
+  // The fast path only recognizes concrete memory within a single page. If the
+  // entire memory region is concrete, don't create a symbolic expression at
+  // all.
   if (isConcrete(addr, length))
     return nullptr;
 
@@ -161,10 +151,8 @@ SymExpr _sym_read_memory(uint8_t *addr, size_t length, bool little_endian) {
                          });
 }
 
-void _sym_write_memory(uint8_t *addr, size_t length, SymExpr expr,
-                       bool little_endian) {
-  assert(length && "Invalid query for zero-length memory region");
-
+void writeSymbolicMemory(uint8_t *addr, size_t length, SymExpr expr,
+                         bool little_endian) {
 #ifdef DEBUG_RUNTIME
   std::cerr << "Writing " << length << " bytes to address " << P(addr)
             << std::endl;
@@ -474,11 +462,41 @@ void symcc_make_symbolic(const void *start, size_t byte_length) {
     throw std::runtime_error{"Calls to symcc_make_symbolic aren't allowed when "
                              "SYMCC_MEMORY_INPUT isn't set"};
 
-  static size_t inputOffset = 0; // track the offset across calls
-  _sym_make_symbolic(start, byte_length, inputOffset);
-  inputOffset += byte_length;
+  maybeRunExplorer(-1);
+  patchMemoryInput(const_cast<void *>(start), byte_length,
+                   g_memory_input_offset);
+
+  _sym_make_symbolic(start, byte_length, g_memory_input_offset);
+  g_memory_input_offset += byte_length;
+}
+
+int symcc_persistent_loop(unsigned int max_iterations) {
+  static unsigned int iterations = 0;
+
+  if (iterations > 0) {
+    // Forget the previous execution. All expressions are released, so we need
+    // to clear every place that may still refer to them.
+    g_return_value = nullptr;
+    g_function_arguments.fill(nullptr);
+    g_memory_input_offset = 0;
+    clearShadowMemory();
+    clearExpressionRegions();
+    resetLibcWrappers();
+    _sym_reset_backend();
+
+    // The solving deadline applies to each iteration separately.
+    g_query_scheduler.restartDeadline();
+  }
+
+  if (iterations >= max_iterations)
+    return 0;
+
+  iterations++;
+  return 1;
 }
 
+void symcc_snapshot(void) { snapshotInput(); }
+
 SymExpr _sym_build_bit_to_bool(SymExpr expr) {
   if (expr == nullptr)
     return nullptr;
@@ -16,3 +16,36 @@
 #include "Shadow.h"
 
 std::map<uintptr_t, SymExpr *> g_shadow_pages;
+
+SymExpr **_sym_shadow_table[SYM_SHADOW_DIRECTORY_SIZE];
+
+SymExpr *createShadow(uintptr_t addr) {
+  auto *shadow = static_cast<SymExpr *>(calloc(kPageSize, sizeof(SymExpr)));
+  g_shadow_pages[pageStart(addr)] = shadow;
+
+  if (inShadowTable(addr)) {
+    auto *&leaf = _sym_shadow_table[addr >> (SYM_SHADOW_LEAF_BITS +
+                                              SYM_SHADOW_PAGE_BITS)];
+    if (leaf == nullptr) {
+      // The leaves are large, but the kernel only provides the pages of
+      // zero-initialized memory that we actually touch.
+      leaf = static_cast<SymExpr **>(
+          calloc(1 << SYM_SHADOW_LEAF_BITS, sizeof(SymExpr *)));
+    }
+    leaf[(addr >> SYM_SHADOW_PAGE_BITS) & ((1 << SYM_SHADOW_LEAF_BITS) - 1)] =
+        shadow;
+  }
+
+  return shadow;
+}
+
+void clearShadowMemory() {
+  for (auto &[page, shadow] : g_shadow_pages)
+    free(shadow);
+  g_shadow_pages.clear();
+
+  for (auto *&leaf : _sym_shadow_table) {
+    free(leaf);
+    leaf = nullptr;
+  }
+}
@@ -0,0 +1,114 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#include "TestCaseFilter.h"
+
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Config.h"
+
+namespace {
+
+/// The name of the file (in the output directory) that holds the hashes of
+/// test cases from previous executions.
+constexpr const char *kHashFileName = ".symcc_test_case_hashes";
+
+/// The hashes of all test cases that we know about.
+std::unordered_set<uint64_t> g_hashes;
+
+/// The file with persistent hashes, or -1 if we don't use one (yet).
+int g_hash_file = -1;
+
+/// Have we tried to open the hash file?
+bool g_hash_file_opened = false;
+
+/// The number of bytes of the hash file that we have loaded so far.
+off_t g_hash_file_loaded = 0;
+
+void openHashFile() {
+  g_hash_file_opened = true;
+  if (!g_config.deduplicateAcrossRuns)
+    return;
+
+  auto path = g_config.outputDir + "/" + kHashFileName;
+  g_hash_file = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                     S_IRUSR | S_IWUSR);
+  if (g_hash_file == -1)
+    std::cerr << "Warning: can't open " << path << " (" << strerror(errno)
+              << "); only deduplicating test cases of this execution"
+              << std::endl;
+}
+
+/// Load the hashes that have been appended to the file since we last looked.
+void loadNewHashes() {
+  uint64_t buffer[512];
+  while (true) {
+    auto bytesRead =
+        pread(g_hash_file, buffer, sizeof(buffer), g_hash_file_loaded);
+    if (bytesRead <= 0)
+      return;
+
+    // Records are written with a single append each, so we never see half of
+    // one unless the file is corrupt.
+    auto records = static_cast<size_t>(bytesRead) / sizeof(uint64_t);
+    g_hashes.insert(buffer, buffer + records);
+    g_hash_file_loaded += records * sizeof(uint64_t);
+    if (records == 0)
+      return;
+  }
+}
+
+} // namespace
+
+bool isNewTestCase(const std::vector<uint8_t> &input) {
+  if (!g_hash_file_opened)
+    openHashFile();
+
+  uint64_t hash = std::hash<std::string_view>{}(std::string_view(
+      reinterpret_cast<const char *>(input.data()), input.size()));
+
+  if (g_hash_file == -1)
+    return g_hashes.insert(hash).second;
+
+  // Concurrent executions append to the same file, so we hold the lock while
+  // checking and recording the hash.
+  flock(g_hash_file, LOCK_EX);
+  loadNewHashes();
+  bool isNew = g_hashes.insert(hash).second;
+  if (isNew && write(g_hash_file, &hash, sizeof(hash)) != sizeof(hash)) {
+    std::cerr << "Warning: failed to record a test case hash; disabling "
+                 "deduplication across runs"
+              << std::endl;
+    flock(g_hash_file, LOCK_UN);
+    close(g_hash_file);
+    g_hash_file = -1;
+    return isNew;
+  }
+  if (isNew)
+    g_hash_file_loaded += sizeof(hash);
+  flock(g_hash_file, LOCK_UN);
+  return isNew;
+}
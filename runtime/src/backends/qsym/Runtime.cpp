@@ -34,6 +34,9 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_set>
 #include <variant>
 
@@ -63,8 +66,11 @@
 
 // Runtime
 #include <Config.h>
+#include <Explorer.h>
 #include <LibcWrappers.h>
+#include <QueryScheduler.h>
 #include <Shadow.h>
+#include <TestCaseFilter.h>
 
 namespace qsym {
 
@@ -109,6 +115,22 @@ SymExpr registerExpression(const qsym::ExprRef &expr) {
 /// writing the test case to a file in the output directory.
 TestCaseHandler g_test_case_handler = nullptr;
 
+/// Determine the file that QSYM should use for its coverage map.
+///
+/// QSYM only knows how to load the map from a file and store it back at exit.
+/// On Linux, POSIX shared-memory objects are files in /dev/shm, so a shared map
+/// at least avoids the round-trip to disk; unlike the simple backend, though,
+/// QSYM doesn't see updates from concurrent executions.
+std::string coverageMapPath() {
+  if (g_config.aflCoverageShm.empty())
+    return g_config.aflCoverageMap;
+
+  auto name = std::string_view(g_config.aflCoverageShm);
+  if (!name.empty() && name.front() == '/')
+    name.remove_prefix(1);
+  return "/dev/shm/" + std::string(name);
+}
+
 /// A QSYM solver that doesn't require the entire input on initialization.
 class EnhancedQsymSolver : public qsym::Solver {
   // Warning!
@@ -124,7 +146,7 @@ class EnhancedQsymSolver : public qsym::Solver {
 
 public:
   EnhancedQsymSolver()
-      : qsym::Solver("/dev/null", g_config.outputDir, g_config.aflCoverageMap) {
+      : qsym::Solver("/dev/null", g_config.outputDir, coverageMapPath()) {
   }
 
   void pushInputByte(size_t offset, uint8_t value) {
@@ -134,9 +156,62 @@ public:
     inputs_[offset] = value;
   }
 
+  /// Forget all path constraints and the input.
+  void resetPathConstraints() {
+    reset();
+    dep_forest_ = qsym::DependencyForest<qsym::Expr>{};
+    inputs_.clear();
+  }
+
+  /// Add a path constraint without trying to negate it.
+  void addJccWithoutSolving(qsym::ExprRef e, bool taken) {
+    if (e->isConcrete() || e->kind() == qsym::Bool)
+      return;
+
+    addConstraint(e, taken, false);
+  }
+
+  /// Add a path constraint and try to negate it, like addJcc.
+  ///
+  /// Return the outcome of the query, or nothing if QSYM didn't query the
+  /// solver because its coverage map says that the branch isn't interesting.
+  /// Solutions count as such even if we drop them as duplicates.
+  std::optional<QueryOutcome> addJccAndSolve(qsym::ExprRef e, bool taken,
+                                             uintptr_t site_id) {
+    std::optional<QueryOutcome> outcome;
+    bool interesting = isInterestingJcc(e, taken, site_id);
+    if (interesting) {
+      // QSYM doesn't tell us the solver's verdict, so we can't distinguish
+      // unsatisfiable queries from timeouts.
+      auto before = testCases;
+      negatePath(e, taken);
+      outcome =
+          (testCases > before) ? QueryOutcome::Sat : QueryOutcome::Failed;
+    }
+
+    addConstraint(e, taken, interesting);
+    return outcome;
+  }
+
+  /// Set the solver timeout for subsequent queries (in milliseconds).
+  void setTimeout(unsigned timeout) {
+    if (timeout == currentTimeout)
+      return;
+
+    z3::params params(context_);
+    params.set(":timeout", timeout);
+    solver_.set(params);
+    currentTimeout = timeout;
+  }
+
   void saveValues(const std::string &suffix) override {
+    testCases++;
+    auto values = getConcreteValues();
+    if (!isNewTestCase(values))
+      return;
+
+    reportNewInput(values);
     if (auto handler = g_test_case_handler) {
-      auto values = getConcreteValues();
       // The test-case handler may be instrumented, so let's call it with
       // argument expressions to meet instrumented code's expectations.
       // Otherwise, we might end up erroneously using whatever expression was
@@ -148,10 +223,20 @@ public:
       Solver::saveValues(suffix);
     }
   }
+
+private:
+  /// The number of test cases generated so far, including duplicates that we
+  /// didn't emit.
+  size_t testCases = 0;
+  unsigned currentTimeout = 0;
 };
 
 EnhancedQsymSolver *g_enhanced_solver;
 
+/// The number of path constraints that we've passed to QSYM; they determine
+/// the timeout.
+size_t g_path_length = 0;
+
 } // namespace
 
 using namespace qsym;
@@ -162,12 +247,30 @@ namespace fs = std::filesystem;
 namespace fs = std::experimental::filesystem;
 #endif
 
+namespace {
+
+/// Set up the solver and the expression builder.
+///
+/// This happens lazily when the program obtains its first symbolic input, so
+/// that fully concrete executions don't pay for it.
+void enterSymbolicMode() {
+  g_z3_context = new z3::context{};
+  g_enhanced_solver = new EnhancedQsymSolver{};
+  g_solver = g_enhanced_solver; // for QSYM-internal use
+  g_expr_builder = g_config.pruning ? PruneExprBuilder::create()
+                                    : SymbolicExprBuilder::create();
+  _sym_symbolic_mode = true;
+}
+
+} // namespace
+
 void _sym_initialize(void) {
   if (g_initialized.test_and_set())
     return;
 
   loadConfig();
   initLibcWrappers();
+  initQueryScheduler();
   std::cerr << "This is SymCC running with the QSYM backend" << std::endl;
   if (std::holds_alternative<NoInput>(g_config.input)) {
     std::cerr
@@ -185,11 +288,10 @@ void _sym_initialize(void) {
     exit(-1);
   }
 
-  g_z3_context = new z3::context{};
-  g_enhanced_solver = new EnhancedQsymSolver{};
-  g_solver = g_enhanced_solver; // for QSYM-internal use
-  g_expr_builder = g_config.pruning ? PruneExprBuilder::create()
-                                    : SymbolicExprBuilder::create();
+  // Children of the fork server or the explorer should inherit a ready-to-use
+  // solver.
+  if (g_config.forkServer || g_config.exploreWorkers > 0)
+    enterSymbolicMode();
 }
 
 SymExpr _sym_build_integer(uint64_t value, uint8_t bits) {
@@ -316,15 +418,68 @@ SymExpr _sym_build_trunc(SymExpr expr, uint8_t bits) {
       g_expr_builder->createTrunc(allocatedExpressions.at(expr), bits));
 }
 
+namespace {
+
+/// Add a path constraint, and try to negate it unless the site is backing off.
+void pushPathConstraint(const qsym::ExprRef &expr, bool taken,
+                        uintptr_t site_id) {
+  if (expr->isConcrete() || expr->kind() == Bool) {
+    g_solver->addJcc(expr, taken, site_id);
+    return;
+  }
+
+  auto pathLength = g_path_length++;
+  if (!g_query_scheduler.shouldSolve(site_id)) {
+    g_enhanced_solver->addJccWithoutSolving(expr, taken);
+    return;
+  }
+
+  g_enhanced_solver->setTimeout(g_query_scheduler.queryTimeout(pathLength));
+  auto start = QueryScheduler::Clock::now();
+  auto outcome = g_enhanced_solver->addJccAndSolve(expr, taken, site_id);
+  if (outcome.has_value())
+    g_query_scheduler.recordQuery(site_id, *outcome,
+                                  QueryScheduler::Clock::now() - start);
+}
+
+} // namespace
+
 void _sym_push_path_constraint(SymExpr constraint, int taken,
                                uintptr_t site_id) {
   if (constraint == nullptr)
     return;
 
-  g_solver->addJcc(allocatedExpressions.at(constraint), taken != 0, site_id);
+  pushPathConstraint(allocatedExpressions.at(constraint), taken != 0, site_id);
+}
+
+void _sym_push_switch_constraint(SymExpr expr, const uint64_t *case_values,
+                                 size_t num_cases, size_t taken_index,
+                                 uintptr_t site_id) {
+  if (expr == nullptr)
+    return;
+
+  // QSYM's solver only knows how to negate a single branch condition, so we
+  // present the switch as the chain of comparisons that it stands for.
+  auto value = allocatedExpressions.at(expr);
+  for (size_t i = 0; i < num_cases; i++) {
+    // Like in _sym_build_integer, values that don't fit into uintptr_t need an
+    // llvm::APInt (of the condition's width) on 32-bit systems.
+    uintptr_t narrowValue = case_values[i];
+    auto caseValue =
+        (narrowValue == case_values[i])
+            ? g_expr_builder->createConstant(narrowValue, value->bits())
+            : g_expr_builder->createConstant(
+                  {static_cast<unsigned>(value->bits()), case_values[i]},
+                  value->bits());
+    pushPathConstraint(g_expr_builder->createEqual(value, caseValue),
+                       i == taken_index, site_id);
+  }
 }
 
 SymExpr _sym_get_input_byte(size_t offset, uint8_t value) {
+  if (!_sym_symbolic_mode)
+    enterSymbolicMode();
+
   g_enhanced_solver->pushInputByte(offset, value);
   return registerExpression(g_expr_builder->createRead(offset));
 }
@@ -479,6 +634,19 @@ void _sym_collect_garbage() {
 #endif
 }
 
+//
+// Persistent mode
+//
+
+void _sym_reset_backend() {
+  if (!_sym_symbolic_mode)
+    return;
+
+  allocatedExpressions.clear();
+  g_enhanced_solver->resetPathConstraints();
+  g_path_length = 0;
+}
+
 //
 // Test-case handling
 //
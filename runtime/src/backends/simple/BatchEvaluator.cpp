@@ -0,0 +1,423 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#include "BatchEvaluator.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kLanes = BatchEvaluator::kLanes;
+using Lanes = BatchEvaluator::Lanes;
+
+/// The name prefix of input variables (see _sym_get_input_byte).
+constexpr char kInputPrefix[] = "stdin";
+
+uint64_t mask(unsigned width) {
+  return (width >= 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+}
+
+int64_t signExtend(uint64_t value, unsigned width) {
+  auto shift = 64 - width;
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+bool isNegative(uint64_t value, unsigned width) {
+  return (value >> (width - 1)) & 1;
+}
+
+uint64_t absolute(uint64_t value, unsigned width) {
+  return isNegative(value, width) ? (-value & mask(width)) : value;
+}
+
+// The helpers below apply an operation to all lanes. They are deliberately
+// kept trivial so that the compiler can vectorize the loops.
+
+template <typename F> void unary(Lanes &result, const Lanes &a, F f) {
+  for (size_t i = 0; i < kLanes; i++)
+    result[i] = f(a[i]);
+}
+
+template <typename F>
+void binary(Lanes &result, const Lanes &a, const Lanes &b, F f) {
+  for (size_t i = 0; i < kLanes; i++)
+    result[i] = f(a[i], b[i]);
+}
+
+/// Division as defined by SMT-LIB, including division by zero.
+uint64_t udiv(uint64_t a, uint64_t b, unsigned width) {
+  return (b == 0) ? mask(width) : a / b;
+}
+
+uint64_t urem(uint64_t a, uint64_t b) { return (b == 0) ? a : a % b; }
+
+uint64_t sdiv(uint64_t a, uint64_t b, unsigned width) {
+  if (b == 0)
+    return isNegative(a, width) ? 1 : mask(width);
+
+  auto quotient = absolute(a, width) / absolute(b, width);
+  return ((isNegative(a, width) != isNegative(b, width)) ? -quotient
+                                                         : quotient) &
+         mask(width);
+}
+
+uint64_t srem(uint64_t a, uint64_t b, unsigned width) {
+  if (b == 0)
+    return a;
+
+  auto remainder = absolute(a, width) % absolute(b, width);
+  return (isNegative(a, width) ? -remainder : remainder) & mask(width);
+}
+
+uint64_t smod(uint64_t a, uint64_t b, unsigned width) {
+  if (b == 0)
+    return a;
+
+  auto remainder = srem(a, b, width);
+  if (remainder != 0 && isNegative(remainder, width) != isNegative(b, width))
+    remainder = (remainder + b) & mask(width);
+  return remainder;
+}
+
+} // namespace
+
+BatchEvaluator::BatchEvaluator(Z3_context context,
+                               const std::vector<Candidate> &candidates)
+    : context(context) {
+  assert(!candidates.empty() && candidates.size() <= kLanes &&
+         "Invalid number of candidates");
+
+  for (size_t i = 0; i < kLanes; i++)
+    lanes[i] = &candidates[i < candidates.size() ? i : 0];
+}
+
+bool BatchEvaluator::getWidth(Z3_ast expr, unsigned &width) {
+  auto *sort = Z3_get_sort(context, expr);
+  switch (Z3_get_sort_kind(context, sort)) {
+  case Z3_BOOL_SORT:
+    width = 1;
+    return true;
+  case Z3_BV_SORT:
+    width = Z3_get_bv_sort_size(context, sort);
+    return width <= 64;
+  default:
+    return false;
+  }
+}
+
+bool BatchEvaluator::evaluate(Z3_ast expr, Lanes &result) {
+  auto id = Z3_get_ast_id(context, expr);
+  if (auto it = cache.find(id); it != cache.end()) {
+    result = it->second;
+    return true;
+  }
+
+  unsigned width;
+  if (!getWidth(expr, width))
+    return false;
+
+  switch (Z3_get_ast_kind(context, expr)) {
+  case Z3_NUMERAL_AST: {
+    uint64_t value;
+    if (!Z3_get_numeral_uint64(context, expr, &value))
+      return false;
+    result.fill(value);
+    break;
+  }
+  case Z3_APP_AST:
+    if (!evaluateApp(expr, width, result))
+      return false;
+    break;
+  default:
+    return false;
+  }
+
+  cache.emplace(id, result);
+  return true;
+}
+
+bool BatchEvaluator::evaluateVariable(Z3_func_decl decl, Lanes &result) {
+  const char *name =
+      Z3_get_symbol_string(context, Z3_get_decl_name(context, decl));
+  if (strncmp(name, kInputPrefix, sizeof(kInputPrefix) - 1) != 0)
+    return false;
+
+  char *end;
+  auto index = strtoul(name + sizeof(kInputPrefix) - 1, &end, 10);
+  if (*end != '\0')
+    return false;
+
+  for (size_t i = 0; i < kLanes; i++) {
+    if (index >= lanes[i]->size())
+      return false;
+    result[i] = (*lanes[i])[index];
+  }
+
+  return true;
+}
+
+bool BatchEvaluator::evaluateArgs(Z3_app app, std::vector<Lanes> &args,
+                                  std::vector<unsigned> &widths) {
+  auto numArgs = Z3_get_app_num_args(context, app);
+  args.resize(numArgs);
+  widths.resize(numArgs);
+  for (unsigned i = 0; i < numArgs; i++) {
+    auto *arg = Z3_get_app_arg(context, app, i);
+    if (!getWidth(arg, widths[i]) || !evaluate(arg, args[i]))
+      return false;
+  }
+
+  return true;
+}
+
+bool BatchEvaluator::evaluateApp(Z3_ast expr, unsigned width, Lanes &result) {
+  auto *app = Z3_to_app(context, expr);
+  auto *decl = Z3_get_app_decl(context, app);
+  auto kind = Z3_get_decl_kind(context, decl);
+
+  switch (kind) {
+  case Z3_OP_TRUE:
+    result.fill(1);
+    return true;
+  case Z3_OP_FALSE:
+    result.fill(0);
+    return true;
+  case Z3_OP_UNINTERPRETED:
+    return Z3_get_app_num_args(context, app) == 0 &&
+           evaluateVariable(decl, result);
+  default:
+    break;
+  }
+
+  std::vector<Lanes> args;
+  std::vector<unsigned> widths;
+  if (!evaluateArgs(app, args, widths) || args.empty())
+    return false;
+
+  auto m = mask(width);
+  // The width of the (first) argument, needed for comparisons and signed
+  // operations.
+  auto w = widths[0];
+
+  switch (kind) {
+  case Z3_OP_NOT:
+    unary(result, args[0], [](uint64_t a) { return a ^ 1; });
+    return true;
+  case Z3_OP_BNOT:
+    unary(result, args[0], [m](uint64_t a) { return ~a & m; });
+    return true;
+  case Z3_OP_BNEG:
+    unary(result, args[0], [m](uint64_t a) { return -a & m; });
+    return true;
+  case Z3_OP_BREDOR:
+    unary(result, args[0], [](uint64_t a) { return uint64_t(a != 0); });
+    return true;
+  case Z3_OP_BREDAND:
+    unary(result, args[0],
+          [wm = mask(w)](uint64_t a) { return uint64_t(a == wm); });
+    return true;
+  case Z3_OP_ZERO_EXT:
+    result = args[0];
+    return true;
+  case Z3_OP_SIGN_EXT:
+    unary(result, args[0], [w, m](uint64_t a) {
+      return static_cast<uint64_t>(signExtend(a, w)) & m;
+    });
+    return true;
+  case Z3_OP_EXTRACT: {
+    auto low = Z3_get_decl_int_parameter(context, decl, 1);
+    unary(result, args[0], [low, m](uint64_t a) { return (a >> low) & m; });
+    return true;
+  }
+  case Z3_OP_ROTATE_LEFT:
+  case Z3_OP_ROTATE_RIGHT: {
+    unsigned amount = Z3_get_decl_int_parameter(context, decl, 0) % width;
+    if (kind == Z3_OP_ROTATE_RIGHT)
+      amount = (width - amount) % width;
+    if (amount == 0) {
+      result = args[0];
+      return true;
+    }
+    unary(result, args[0], [amount, width, m](uint64_t a) {
+      return ((a << amount) | (a >> (width - amount))) & m;
+    });
+    return true;
+  }
+  case Z3_OP_ITE:
+    for (size_t i = 0; i < kLanes; i++)
+      result[i] = args[0][i] ? args[1][i] : args[2][i];
+    return true;
+  default:
+    break;
+  }
+
+  // N-ary operations (Z3 likes to merge nested associative operations).
+  switch (kind) {
+  case Z3_OP_AND:
+  case Z3_OP_BAND:
+    result = args[0];
+    for (size_t j = 1; j < args.size(); j++)
+      binary(result, result, args[j],
+             [](uint64_t a, uint64_t b) { return a & b; });
+    return true;
+  case Z3_OP_OR:
+  case Z3_OP_BOR:
+    result = args[0];
+    for (size_t j = 1; j < args.size(); j++)
+      binary(result, result, args[j],
+             [](uint64_t a, uint64_t b) { return a | b; });
+    return true;
+  case Z3_OP_XOR:
+  case Z3_OP_BXOR:
+    result = args[0];
+    for (size_t j = 1; j < args.size(); j++)
+      binary(result, result, args[j],
+             [](uint64_t a, uint64_t b) { return a ^ b; });
+    return true;
+  case Z3_OP_BADD:
+    result = args[0];
+    for (size_t j = 1; j < args.size(); j++)
+      binary(result, result, args[j],
+             [m](uint64_t a, uint64_t b) { return (a + b) & m; });
+    return true;
+  case Z3_OP_BMUL:
+    result = args[0];
+    for (size_t j = 1; j < args.size(); j++)
+      binary(result, result, args[j],
+             [m](uint64_t a, uint64_t b) { return (a * b) & m; });
+    return true;
+  case Z3_OP_CONCAT:
+    result = args[0];
+    for (size_t j = 1; j < args.size(); j++)
+      binary(result, result, args[j],
+             [shift = widths[j]](uint64_t a, uint64_t b) {
+        return (a << shift) | b;
+      });
+    return true;
+  default:
+    break;
+  }
+
+  if (args.size() != 2)
+    return false;
+  const auto &a = args[0];
+  const auto &b = args[1];
+
+  switch (kind) {
+  case Z3_OP_EQ:
+  case Z3_OP_IFF:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x == y); });
+    return true;
+  case Z3_OP_DISTINCT:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x != y); });
+    return true;
+  case Z3_OP_IMPLIES:
+    binary(result, a, b, [](uint64_t x, uint64_t y) { return (x ^ 1) | y; });
+    return true;
+  case Z3_OP_BCOMP:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x == y); });
+    return true;
+  case Z3_OP_BSUB:
+    binary(result, a, b, [m](uint64_t x, uint64_t y) { return (x - y) & m; });
+    return true;
+  case Z3_OP_BNAND:
+    binary(result, a, b, [m](uint64_t x, uint64_t y) { return ~(x & y) & m; });
+    return true;
+  case Z3_OP_BNOR:
+    binary(result, a, b, [m](uint64_t x, uint64_t y) { return ~(x | y) & m; });
+    return true;
+  case Z3_OP_BXNOR:
+    binary(result, a, b, [m](uint64_t x, uint64_t y) { return ~(x ^ y) & m; });
+    return true;
+  case Z3_OP_BUDIV:
+  case Z3_OP_BUDIV_I:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) { return udiv(x, y, w); });
+    return true;
+  case Z3_OP_BUREM:
+  case Z3_OP_BUREM_I:
+    binary(result, a, b, [](uint64_t x, uint64_t y) { return urem(x, y); });
+    return true;
+  case Z3_OP_BSDIV:
+  case Z3_OP_BSDIV_I:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) { return sdiv(x, y, w); });
+    return true;
+  case Z3_OP_BSREM:
+  case Z3_OP_BSREM_I:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) { return srem(x, y, w); });
+    return true;
+  case Z3_OP_BSMOD:
+  case Z3_OP_BSMOD_I:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) { return smod(x, y, w); });
+    return true;
+  case Z3_OP_BSHL:
+    binary(result, a, b, [w, m](uint64_t x, uint64_t y) {
+      return (y >= w) ? 0 : (x << y) & m;
+    });
+    return true;
+  case Z3_OP_BLSHR:
+    binary(result, a, b,
+           [w](uint64_t x, uint64_t y) { return (y >= w) ? 0 : x >> y; });
+    return true;
+  case Z3_OP_BASHR:
+    binary(result, a, b, [w, m](uint64_t x, uint64_t y) {
+      return static_cast<uint64_t>(signExtend(x, w) >> (y >= w ? w - 1 : y)) &
+             m;
+    });
+    return true;
+  case Z3_OP_ULEQ:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x <= y); });
+    return true;
+  case Z3_OP_UGEQ:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x >= y); });
+    return true;
+  case Z3_OP_ULT:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x < y); });
+    return true;
+  case Z3_OP_UGT:
+    binary(result, a, b,
+           [](uint64_t x, uint64_t y) { return uint64_t(x > y); });
+    return true;
+  case Z3_OP_SLEQ:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) {
+      return uint64_t(signExtend(x, w) <= signExtend(y, w));
+    });
+    return true;
+  case Z3_OP_SGEQ:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) {
+      return uint64_t(signExtend(x, w) >= signExtend(y, w));
+    });
+    return true;
+  case Z3_OP_SLT:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) {
+      return uint64_t(signExtend(x, w) < signExtend(y, w));
+    });
+    return true;
+  case Z3_OP_SGT:
+    binary(result, a, b, [w](uint64_t x, uint64_t y) {
+      return uint64_t(signExtend(x, w) > signExtend(y, w));
+    });
+    return true;
+  default:
+    return false;
+  }
+}
@@ -0,0 +1,79 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <z3.h>
+
+/// Evaluate expressions over several candidate inputs at once.
+///
+/// A candidate assigns a concrete value to each input byte, i.e., to each of
+/// the "stdin" variables created by _sym_get_input_byte. The evaluator walks
+/// the expression DAG only once for all candidates; at each node, it performs
+/// the operation on a fixed number of lanes, one per candidate, in a simple
+/// loop that the compiler can turn into vector instructions.
+///
+/// Only Boolean connectives and bit-vector operations on up to 64 bits are
+/// supported. Evaluation fails on anything else (e.g., floating-point
+/// arithmetic), so that callers can fall back to the solver.
+class BatchEvaluator {
+public:
+  /// The number of candidates that are evaluated together.
+  static constexpr size_t kLanes = 16;
+
+  /// The values of an expression for all candidates.
+  ///
+  /// Bit vectors are stored zero-extended, Booleans as 0 or 1.
+  using Lanes = std::array<uint64_t, kLanes>;
+
+  /// A candidate input, indexed by the number of the input variable.
+  using Candidate = std::vector<uint8_t>;
+
+  /// Prepare the evaluation of the given candidates.
+  ///
+  /// There must be at least one and at most kLanes candidates; the objects
+  /// have to outlive the evaluator.
+  BatchEvaluator(Z3_context context, const std::vector<Candidate> &candidates);
+
+  /// Evaluate an expression for all candidates.
+  ///
+  /// Returns false if the expression can't be evaluated. Results are cached,
+  /// so evaluating several expressions that share subexpressions is cheap.
+  bool evaluate(Z3_ast expr, Lanes &result);
+
+private:
+  bool evaluateApp(Z3_ast expr, unsigned width, Lanes &result);
+  bool evaluateArgs(Z3_app app, std::vector<Lanes> &args,
+                    std::vector<unsigned> &widths);
+  bool evaluateVariable(Z3_func_decl decl, Lanes &result);
+  bool getWidth(Z3_ast expr, unsigned &width);
+
+  Z3_context context;
+
+  /// One candidate per lane; unused lanes repeat the first candidate.
+  std::array<const Candidate *, kLanes> lanes;
+
+  /// Results of previous evaluations, indexed by AST ID.
+  std::unordered_map<unsigned, Lanes> cache;
+};
+
+#endif
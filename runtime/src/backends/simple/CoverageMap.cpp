@@ -0,0 +1,146 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#include "CoverageMap.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t mix(uint64_t hash, uint64_t value) {
+  hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+  return hash * 0xff51afd7ed558ccd;
+}
+
+/// Map a hit count to its AFL count class.
+uint8_t countClass(uint32_t count) {
+  if (count <= 3)
+    return 1 << (count - 1);
+  if (count <= 7)
+    return 1 << 3;
+  if (count <= 15)
+    return 1 << 4;
+  if (count <= 31)
+    return 1 << 5;
+  if (count <= 127)
+    return 1 << 6;
+  return 1 << 7;
+}
+
+[[noreturn]] void fail(const std::string &name, bool sharedMemory,
+                       const char *what) {
+  std::cerr << "Error: failed to " << what << " the coverage map " << name
+            << " (configured via "
+            << (sharedMemory ? "SYMCC_AFL_COVERAGE_SHM"
+                             : "SYMCC_AFL_COVERAGE_MAP")
+            << "): " << strerror(errno) << std::endl;
+  exit(-1);
+}
+
+} // namespace
+
+CoverageMap::CoverageMap(const std::string &name, bool sharedMemory)
+    : hitCounts(kMapSize) {
+  int fd = sharedMemory ? shm_open(name.c_str(), O_RDWR | O_CREAT, 0600)
+                        : open(name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1)
+    fail(name, sharedMemory, "open");
+
+  // Concurrent executions may try to create the map at the same time; only one
+  // of them must initialize it.
+  if (flock(fd, LOCK_EX) == -1)
+    fail(name, sharedMemory, "lock");
+
+  struct stat fileInfo;
+  if (fstat(fd, &fileInfo) == -1)
+    fail(name, sharedMemory, "inspect");
+
+  bool fresh = (fileInfo.st_size == 0);
+  if (fresh && ftruncate(fd, kMapSize) == -1)
+    fail(name, sharedMemory, "resize");
+  if (!fresh && static_cast<size_t>(fileInfo.st_size) != kMapSize) {
+    std::cerr << "Error: the coverage map " << name
+              << " has an unexpected size" << std::endl;
+    exit(-1);
+  }
+
+  void *map =
+      mmap(nullptr, kMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+    fail(name, sharedMemory, "map");
+
+  virginMap = static_cast<uint8_t *>(map);
+  if (fresh)
+    memset(virginMap, 0xff, kMapSize);
+
+  // Closing the descriptor releases the lock.
+  close(fd);
+}
+
+CoverageMap::~CoverageMap() { munmap(virginMap, kMapSize); }
+
+void CoverageMap::resetExecution() {
+  std::fill(hitCounts.begin(), hitCounts.end(), 0);
+  callStack.clear();
+  context = 0;
+}
+
+void CoverageMap::enterFunction(uintptr_t siteId) {
+  callStack.push_back(context);
+  context = mix(context, siteId);
+}
+
+void CoverageMap::leaveFunction() {
+  // Returns without matching calls happen, e.g., when the program was entered
+  // from uninstrumented code.
+  if (callStack.empty())
+    return;
+
+  context = callStack.back();
+  callStack.pop_back();
+}
+
+size_t CoverageMap::edgeIndex(uintptr_t siteId, bool taken) const {
+  return mix(mix(context, siteId), taken) & (kMapSize - 1);
+}
+
+bool CoverageMap::visitBranch(uintptr_t siteId, bool taken) {
+  auto takenEdge = edgeIndex(siteId, taken);
+  auto &hits = hitCounts[takenEdge];
+  if (hits < std::numeric_limits<uint8_t>::max())
+    hits++;
+  __atomic_fetch_and(&virginMap[takenEdge],
+                     static_cast<uint8_t>(~countClass(hits)), __ATOMIC_RELAXED);
+
+  // Clear the alternative's bit and check whether it was set in one step, so
+  // that only one of several concurrent executions gets to explore it.
+  auto alternativeEdge = edgeIndex(siteId, !taken);
+  auto alternativeClass = countClass(hitCounts[alternativeEdge] + 1u);
+  auto previous = __atomic_fetch_and(&virginMap[alternativeEdge],
+                                     static_cast<uint8_t>(~alternativeClass),
+                                     __ATOMIC_RELAXED);
+  return (previous & alternativeClass) != 0;
+}
@@ -0,0 +1,80 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with the SymCC runtime. If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef COVERAGEMAP_H
+#define COVERAGEMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// An AFL-style map of the branch edges that we have already explored.
+///
+/// Edges are identified by the branch's site ID, the direction, and a hash of
+/// the call stack (i.e., the map is context sensitive). Like AFL's "virgin"
+/// map, the persistent map contains one byte per edge, and each bit of the
+/// byte corresponds to a class of hit counts; a set bit means that we haven't
+/// seen the edge with the corresponding number of hits yet.
+///
+/// The map is backed by a file or a POSIX shared-memory object, so that the
+/// state of exploration carries over between executions. It is mapped into
+/// memory and updated in place with atomic operations, so concurrent
+/// executions see each other's progress immediately and never claim the same
+/// edge twice.
+class CoverageMap {
+public:
+  static constexpr size_t kMapSize = 1 << 16;
+
+  /// Open (or create) the map stored in the given file or shared-memory
+  /// object.
+  CoverageMap(const std::string &name, bool sharedMemory);
+  ~CoverageMap();
+
+  CoverageMap(const CoverageMap &) = delete;
+  CoverageMap &operator=(const CoverageMap &) = delete;
+
+  /// Forget the hit counts and the call stack of the current execution.
+  void resetExecution();
+
+  /// Track the call stack for context sensitivity.
+  void enterFunction(uintptr_t siteId);
+  void leaveFunction();
+
+  /// Record that the program took a branch in the given direction.
+  ///
+  /// Returns true if the alternative direction would lead to an edge that we
+  /// haven't seen before. In that case, the alternative is considered covered
+  /// from now on, assuming that the caller tries to generate an input for it.
+  bool visitBranch(uintptr_t siteId, bool taken);
+
+private:
+  size_t edgeIndex(uintptr_t siteId, bool taken) const;
+
+  /// The persistent map, shared with the backing object.
+  uint8_t *virginMap;
+
+  /// The number of times we've seen each edge during the current execution
+  /// (saturating).
+  std::vector<uint8_t> hitCounts;
+
+  /// The call-stack hashes of all active callers.
+  std::vector<uint64_t> callStack;
+
+  /// The hash of the current call stack.
+  uint64_t context = 0;
+};
+
+#endif
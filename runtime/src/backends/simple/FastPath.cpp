@@ -0,0 +1,26 @@
+// This file is part of the SymCC runtime.
+//
+// The SymCC runtime is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version.
+//
+// The SymCC runtime is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License
+// for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+//
+// The simple backend's contribution to the run-time fast paths (see
+// src/FastPath.cpp).
+//
+
+#include <Runtime.h>
+
+/* Call-stack tracing */
+
+// We don't track basic blocks, so an inlined notification costs nothing.
+void _sym_notify_basic_block(uintptr_t) {}
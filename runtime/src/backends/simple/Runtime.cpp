@@ -18,20 +18,35 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <deque>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <optional>
 #include <set>
+#include <utility>
 #include <vector>
 
 #ifndef NDEBUG
 #include <chrono>
 #endif
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "BatchEvaluator.h"
 #include "Config.h"
+#include "Explorer.h"
+#include "CoverageMap.h"
 #include "GarbageCollection.h"
 #include "LibcWrappers.h"
+#include "QueryScheduler.h"
 #include "Shadow.h"
+#include "TestCaseFilter.h"
 
 #ifndef NDEBUG
 // Helper to print pointers properly.
@@ -64,7 +79,23 @@ Z3_solver g_solver; // TODO make thread-local
 // Some global constants for efficiency.
 Z3_ast g_null_pointer, g_true, g_false;
 
-FILE *g_log = stderr;
+/// The log for solver activity, or null if logging is disabled.
+///
+/// Printing solver queries and models is expensive, so we only do it if the
+/// user asks for a log file.
+FILE *g_log = nullptr;
+
+/// The user-provided test case handler, if any.
+///
+/// If the user doesn't register a handler, we write each test case to a file
+/// in the output directory.
+TestCaseHandler g_test_case_handler = nullptr;
+
+/// The number of the next test-case file to try.
+size_t g_next_test_case = 0;
+
+/// The map of explored branches, if the user configured one.
+std::unique_ptr<CoverageMap> g_coverage_map;
 
 #ifndef NDEBUG
 [[maybe_unused]] void dump_known_regions() {
@@ -105,28 +136,202 @@ SymExpr registerExpression(SymExpr expr) {
   return expr;
 }
 
-} // namespace
+/// The variable for each input byte, indexed by offset.
+std::vector<SymExpr> g_input_bytes;
 
-void _sym_initialize(void) {
-  if (g_initialized.test_and_set())
+/// The concrete value of each input byte, indexed by offset like the input
+/// variables (and zero for bytes that the program hasn't read).
+BatchEvaluator::Candidate g_input_values;
+
+/// The contents of the input file, if the input comes from a file; we only
+/// read it when we need it for the first test case of an execution.
+std::optional<std::vector<uint8_t>> g_input_file_contents;
+
+/// The path constraints asserted so far.
+std::vector<Z3_ast> g_path_constraints;
+
+/// Set the solver timeout for the next query (in milliseconds).
+void setSolverTimeout(unsigned timeout) {
+  static unsigned currentTimeout = 0;
+  if (timeout == currentTimeout)
     return;
 
-#ifndef NDEBUG
-  std::cerr << "Initializing symbolic runtime" << std::endl;
-#endif
+  Z3_params params = Z3_mk_params(g_context);
+  Z3_params_inc_ref(g_context, params);
+  Z3_params_set_uint(g_context, params,
+                     Z3_mk_string_symbol(g_context, "timeout"), timeout);
+  Z3_solver_set_params(g_context, g_solver, params);
+  Z3_params_dec_ref(g_context, params);
+  currentTimeout = timeout;
+}
+
+/// A solution found by the solver, assigning values to input variables.
+using CachedModel = std::vector<std::pair<size_t, uint8_t>>;
+
+/// The most recently found solutions, newest first.
+std::deque<CachedModel> g_model_cache;
+
+/// Extract the values of the input variables from a solver model.
+CachedModel extractModel(Z3_model model) {
+  CachedModel cached;
+  auto numConsts = Z3_model_get_num_consts(g_context, model);
+  for (unsigned i = 0; i < numConsts; i++) {
+    auto *decl = Z3_model_get_const_decl(g_context, model, i);
+    const char *name =
+        Z3_get_symbol_string(g_context, Z3_get_decl_name(g_context, decl));
+    if (strncmp(name, "stdin", 5) != 0)
+      continue;
+
+    uint64_t value;
+    auto *interpretation = Z3_model_get_const_interp(g_context, model, decl);
+    if (interpretation == nullptr ||
+        !Z3_get_numeral_uint64(g_context, interpretation, &value))
+      continue;
+
+    cached.emplace_back(std::stoul(name + 5), value);
+  }
 
-  loadConfig();
-  initLibcWrappers();
-  std::cerr << "This is SymCC running with the simple backend" << std::endl
-            << "For anything but debugging SymCC itself, you will want to use "
-               "the QSYM backend instead (see README.md for build instructions)"
-            << std::endl;
+  std::sort(cached.begin(), cached.end());
+  return cached;
+}
+
+/// Apply a solution to the current input.
+BatchEvaluator::Candidate applyModel(const CachedModel &model) {
+  auto input = g_input_values;
+  for (auto [index, value] : model) {
+    if (index < input.size())
+      input[index] = value;
+  }
+
+  return input;
+}
+
+/// Remember a solution for later queries.
+void cacheModel(CachedModel model) {
+  g_model_cache.push_front(std::move(model));
+  if (g_model_cache.size() > BatchEvaluator::kLanes)
+    g_model_cache.pop_back();
+}
+
+/// Write a test case to a new file in the output directory.
+///
+/// The files are numbered like QSYM's. Other processes (e.g., exploration
+/// children) may write to the same directory, so we never overwrite a file but
+/// take the next free number instead.
+void writeTestCase(const std::vector<uint8_t> &input) {
+  while (true) {
+    char name[24];
+    snprintf(name, sizeof(name), "/%06zu", g_next_test_case++);
+    auto path = g_config.outputDir + name;
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd == -1 && errno == EEXIST)
+      continue;
+
+    if (fd == -1 || write(fd, input.data(), input.size()) !=
+                        static_cast<ssize_t>(input.size()))
+      std::cerr << "Warning: failed to write the test case " << path << ": "
+                << strerror(errno) << std::endl;
+    if (fd != -1)
+      close(fd);
+    return;
+  }
+}
 
+/// Obtain the current input as far as we know it.
+///
+/// For an input file, that's the entire file; otherwise, it's only the bytes
+/// that the program has read so far.
+const std::vector<uint8_t> &originalInput() {
+  if (!g_input_file_contents.has_value()) {
+    g_input_file_contents.emplace();
+    if (auto *fileInput = std::get_if<FileInput>(&g_config.input)) {
+      std::ifstream file(fileInput->fileName, std::ios::binary);
+      g_input_file_contents->assign(std::istreambuf_iterator<char>(file),
+                                    std::istreambuf_iterator<char>());
+    }
+  }
+
+  return *g_input_file_contents;
+}
+
+/// Emit a new input unless we've generated the same one before.
+///
+/// The solution only covers the bytes that the program has read; we take the
+/// others from the current input.
+void emitTestCase(const BatchEvaluator::Candidate &solution) {
+  const auto &original = originalInput();
+  std::vector<uint8_t> input(std::max(solution.size(), original.size()));
+  for (size_t i = 0; i < input.size(); i++) {
+    if (i < solution.size() && g_input_bytes[i] != nullptr)
+      input[i] = solution[i];
+    else if (i < original.size())
+      input[i] = original[i];
+  }
+
+  if (!isNewTestCase(input))
+    return;
+
+  reportNewInput(input);
+  if (auto handler = g_test_case_handler) {
+    // The handler may be instrumented; see the QSYM backend.
+    _sym_set_parameter_expression(0, nullptr);
+    _sym_set_parameter_expression(1, nullptr);
+    handler(input.data(), input.size());
+  } else {
+    writeTestCase(input);
+  }
+}
+
+/// Look for a cached model that leads down the alternative path.
+///
+/// Each cached model is applied to the current input, and the resulting
+/// candidates are checked against the alternative as well as the path
+/// constraints collected so far. We give up as soon as we find an expression
+/// that we can't evaluate; the solver will have to handle the query then.
+std::optional<size_t> findCachedModel(Z3_ast alternative) {
+  if (g_model_cache.empty())
+    return std::nullopt;
+
+  std::vector<BatchEvaluator::Candidate> candidates;
+  for (const auto &model : g_model_cache)
+    candidates.push_back(applyModel(model));
+
+  BatchEvaluator evaluator(g_context, candidates);
+  BatchEvaluator::Lanes satisfied;
+  if (!evaluator.evaluate(alternative, satisfied))
+    return std::nullopt;
+
+  for (auto *constraint : g_path_constraints) {
+    if (std::none_of(satisfied.begin(), satisfied.end(),
+                     [](uint64_t lane) { return lane != 0; }))
+      return std::nullopt;
+
+    BatchEvaluator::Lanes result;
+    if (!evaluator.evaluate(constraint, result))
+      return std::nullopt;
+    for (size_t i = 0; i < BatchEvaluator::kLanes; i++)
+      satisfied[i] &= result[i];
+  }
+
+  for (size_t i = 0; i < candidates.size(); i++) {
+    if (satisfied[i] != 0)
+      return i;
+  }
+
+  return std::nullopt;
+}
+
+/// Set up the solver and everything else that we need for symbolic execution.
+///
+/// This happens lazily when the program obtains its first symbolic input, so
+/// that fully concrete executions don't pay for it.
+void enterSymbolicMode() {
   Z3_config cfg;
 
   cfg = Z3_mk_config();
   Z3_set_param_value(cfg, "model", "true");
-  Z3_set_param_value(cfg, "timeout", "10000"); // milliseconds
+  Z3_set_param_value(cfg, "timeout",
+                     std::to_string(g_config.queryTimeout).c_str()); // ms
   g_context = Z3_mk_context_rc(cfg);
   Z3_del_config(cfg);
 
@@ -150,11 +355,48 @@ void _sym_initialize(void) {
   g_false = Z3_mk_false(g_context);
   Z3_inc_ref(g_context, g_false);
 
-  if (g_config.logFile.empty()) {
-    g_log = stderr;
-  } else {
-    g_log = fopen(g_config.logFile.c_str(), "w");
+  if (!g_config.aflCoverageMap.empty())
+    g_coverage_map = std::make_unique<CoverageMap>(g_config.aflCoverageMap,
+                                                   /*sharedMemory=*/false);
+  else if (!g_config.aflCoverageShm.empty())
+    g_coverage_map = std::make_unique<CoverageMap>(g_config.aflCoverageShm,
+                                                   /*sharedMemory=*/true);
+
+  _sym_symbolic_mode = true;
+}
+
+} // namespace
+
+void _sym_initialize(void) {
+  if (g_initialized.test_and_set())
+    return;
+
+#ifndef NDEBUG
+  std::cerr << "Initializing symbolic runtime" << std::endl;
+#endif
+
+  loadConfig();
+  initLibcWrappers();
+  initQueryScheduler();
+  std::cerr << "This is SymCC running with the simple backend" << std::endl
+            << "For anything but debugging SymCC itself, you will want to use "
+               "the QSYM backend instead (see README.md for build instructions)"
+            << std::endl;
+
+  if (!g_config.logFile.empty()) {
+    // Append, so that we neither erase what's already there (e.g., when the
+    // log goes to /dev/stderr and that is redirected to a file) nor clobber
+    // the logs of other processes that share the file.
+    g_log = fopen(g_config.logFile.c_str(), "a");
+    if (g_log == nullptr)
+      std::cerr << "Warning: can't open the log file " << g_config.logFile
+                << std::endl;
   }
+
+  // Children of the fork server or the explorer should inherit a ready-to-use
+  // solver.
+  if (g_config.forkServer || g_config.exploreWorkers > 0)
+    enterSymbolicMode();
 }
 
 Z3_ast _sym_build_integer(uint64_t value, uint8_t bits) {
@@ -180,17 +422,24 @@ Z3_ast _sym_build_float(double value, int is_double) {
   return result;
 }
 
-Z3_ast _sym_get_input_byte(size_t offset, uint8_t) {
-  static std::vector<SymExpr> stdinBytes;
+Z3_ast _sym_get_input_byte(size_t offset, uint8_t value) {
+  if (!_sym_symbolic_mode)
+    enterSymbolicMode();
 
-  if (offset < stdinBytes.size())
-    return stdinBytes[offset];
+  if (offset < g_input_bytes.size() && g_input_bytes[offset] != nullptr)
+    return g_input_bytes[offset];
 
-  auto varName = "stdin" + std::to_string(stdinBytes.size());
+  // The program may read its input out of order (e.g., after seeking), so
+  // variables are named and stored by offset.
+  auto varName = "stdin" + std::to_string(offset);
   auto *var = build_variable(varName.c_str(), 8);
 
-  stdinBytes.resize(offset);
-  stdinBytes.push_back(var);
+  if (offset >= g_input_bytes.size()) {
+    g_input_bytes.resize(offset + 1);
+    g_input_values.resize(offset + 1);
+  }
+  g_input_bytes[offset] = var;
+  g_input_values[offset] = value;
 
   return var;
 }
@@ -432,7 +681,7 @@ Z3_ast _sym_build_bool_to_bit(Z3_ast expr) {
 }
 
 void _sym_push_path_constraint(Z3_ast constraint, int taken,
-                               uintptr_t site_id [[maybe_unused]]) {
+                               uintptr_t site_id) {
   if (constraint == nullptr)
     return;
 
@@ -460,35 +709,201 @@ void _sym_push_path_constraint(Z3_ast constraint, int taken,
       Z3_simplify(g_context, Z3_mk_not(g_context, constraint));
   Z3_inc_ref(g_context, not_constraint);
 
-  Z3_solver_push(g_context, g_solver);
-  Z3_solver_assert(g_context, g_solver, taken ? not_constraint : constraint);
-  fprintf(g_log, "Trying to solve:\n%s\n",
-          Z3_solver_to_string(g_context, g_solver));
+  /* Skip the query if the site keeps failing or if the alternative doesn't
+     lead anywhere new */
+  bool interesting = g_query_scheduler.shouldSolve(site_id) &&
+                     ((g_coverage_map == nullptr) ||
+                      g_coverage_map->visitBranch(site_id, taken));
+
+  if (interesting) {
+    auto start = QueryScheduler::Clock::now();
+    Z3_solver_push(g_context, g_solver);
+    Z3_solver_assert(g_context, g_solver,
+                     taken ? not_constraint : constraint);
+    if (g_log != nullptr)
+      fprintf(g_log, "Trying to solve:\n%s\n",
+              Z3_solver_to_string(g_context, g_solver));
+
+    std::optional<size_t> cachedModel;
+    if (g_config.modelCache)
+      cachedModel = findCachedModel(taken ? not_constraint : constraint);
+
+    Z3_lbool feasible = Z3_L_TRUE;
+    if (!cachedModel.has_value()) {
+      setSolverTimeout(
+          g_query_scheduler.queryTimeout(g_path_constraints.size()));
+      feasible = Z3_solver_check(g_context, g_solver);
+    }
 
-  Z3_lbool feasible = Z3_solver_check(g_context, g_solver);
-  if (feasible == Z3_L_TRUE) {
-    Z3_model model = Z3_solver_get_model(g_context, g_solver);
-    Z3_model_inc_ref(g_context, model);
-    fprintf(g_log, "Found diverging input:\n%s\n",
-            Z3_model_to_string(g_context, model));
-    Z3_model_dec_ref(g_context, model);
-  } else {
-    fprintf(g_log, "Can't find a diverging input at this point\n");
+    if (cachedModel.has_value()) {
+      if (g_log != nullptr) {
+        fprintf(g_log, "Found diverging input in the model cache:\n");
+        for (auto [index, value] : g_model_cache[*cachedModel])
+          fprintf(g_log, "stdin%zu -> #x%02x\n", index, value);
+        fprintf(g_log, "\n");
+      }
+      emitTestCase(applyModel(g_model_cache[*cachedModel]));
+    } else if (feasible == Z3_L_TRUE) {
+      Z3_model model = Z3_solver_get_model(g_context, g_solver);
+      Z3_model_inc_ref(g_context, model);
+      if (g_log != nullptr)
+        fprintf(g_log, "Found diverging input:\n%s\n",
+                Z3_model_to_string(g_context, model));
+      auto solution = extractModel(model);
+      emitTestCase(applyModel(solution));
+      if (g_config.modelCache)
+        cacheModel(std::move(solution));
+      Z3_model_dec_ref(g_context, model);
+    } else if (g_log != nullptr) {
+      fprintf(g_log, "Can't find a diverging input at this point\n");
+    }
+    if (g_log != nullptr)
+      fflush(g_log);
+
+    Z3_solver_pop(g_context, g_solver, 1);
+
+    QueryOutcome outcome;
+    switch (feasible) {
+    case Z3_L_TRUE:
+      outcome = QueryOutcome::Sat;
+      break;
+    case Z3_L_FALSE:
+      outcome = QueryOutcome::Unsat;
+      break;
+    default:
+      outcome = QueryOutcome::Unknown;
+      break;
+    }
+    g_query_scheduler.recordQuery(site_id, outcome,
+                                  QueryScheduler::Clock::now() - start);
   }
-  fflush(g_log);
-
-  Z3_solver_pop(g_context, g_solver, 1);
 
   /* Assert the actual path constraint */
   Z3_ast newConstraint = (taken ? constraint : not_constraint);
   Z3_inc_ref(g_context, newConstraint);
   Z3_solver_assert(g_context, g_solver, newConstraint);
+  g_path_constraints.push_back(newConstraint);
   assert((Z3_solver_check(g_context, g_solver) == Z3_L_TRUE) &&
          "Asserting infeasible path constraint");
   Z3_dec_ref(g_context, constraint);
   Z3_dec_ref(g_context, not_constraint);
 }
 
+void _sym_push_switch_constraint(Z3_ast expr, const uint64_t *case_values,
+                                 size_t num_cases, size_t taken_index,
+                                 uintptr_t site_id) {
+  if (expr == nullptr || num_cases == 0)
+    return;
+
+  /* cases[i] means that we take case i; the default is the negation of
+     anyCase. */
+  auto *sort = Z3_get_sort(g_context, expr);
+  std::vector<Z3_ast> cases;
+  for (size_t i = 0; i < num_cases; i++) {
+    auto *caseTaken = Z3_mk_eq(
+        g_context, expr, Z3_mk_unsigned_int64(g_context, case_values[i], sort));
+    Z3_inc_ref(g_context, caseTaken);
+    cases.push_back(caseTaken);
+  }
+  Z3_ast anyCase = Z3_mk_or(g_context, num_cases, cases.data());
+  Z3_inc_ref(g_context, anyCase);
+
+  /* Each case (and the default, with index num_cases) counts as a branch of
+     its own for the coverage map. */
+  std::vector<Z3_ast> alternatives;
+  if (g_query_scheduler.shouldSolve(site_id)) {
+    for (size_t i = 0; i <= num_cases; i++) {
+      bool taken = (i == taken_index);
+      bool interesting = (g_coverage_map == nullptr) ||
+                         g_coverage_map->visitBranch(site_id + i, taken);
+      if (!taken && interesting)
+        alternatives.push_back(i < num_cases
+                                   ? cases[i]
+                                   : Z3_mk_not(g_context, anyCase));
+    }
+  }
+
+  /* Rather than solving for each case separately, ask for any alternative and
+     exclude the case of each solution until there are no more; the solver
+     keeps its state for the path prefix in between. */
+  if (!alternatives.empty()) {
+    auto start = QueryScheduler::Clock::now();
+    Z3_solver_push(g_context, g_solver);
+    Z3_solver_assert(g_context, g_solver,
+                     Z3_mk_or(g_context, alternatives.size(),
+                              alternatives.data()));
+    if (g_log != nullptr)
+      fprintf(g_log, "Trying to solve:\n%s\n",
+              Z3_solver_to_string(g_context, g_solver));
+
+    auto outcome = QueryOutcome::Unsat;
+    for (size_t found = 0; found < alternatives.size(); found++) {
+      setSolverTimeout(
+          g_query_scheduler.queryTimeout(g_path_constraints.size()));
+      auto feasible = Z3_solver_check(g_context, g_solver);
+      if (feasible != Z3_L_TRUE) {
+        if (feasible == Z3_L_UNDEF && found == 0)
+          outcome = QueryOutcome::Unknown;
+        if (g_log != nullptr && found == 0)
+          fprintf(g_log, "Can't find a diverging input at this point\n");
+        break;
+      }
+
+      outcome = QueryOutcome::Sat;
+      Z3_model model = Z3_solver_get_model(g_context, g_solver);
+      Z3_model_inc_ref(g_context, model);
+      if (g_log != nullptr)
+        fprintf(g_log, "Found diverging input:\n%s\n",
+                Z3_model_to_string(g_context, model));
+      auto solution = extractModel(model);
+      emitTestCase(applyModel(solution));
+      if (g_config.modelCache)
+        cacheModel(std::move(solution));
+
+      /* Find out which case the solution takes, and exclude it. */
+      Z3_ast value;
+      uint64_t concreteValue = 0;
+      bool evaluated = Z3_model_eval(g_context, model, expr, true, &value);
+      if (evaluated) {
+        Z3_inc_ref(g_context, value);
+        evaluated = Z3_get_numeral_uint64(g_context, value, &concreteValue);
+        Z3_dec_ref(g_context, value);
+      }
+      Z3_model_dec_ref(g_context, model);
+      if (!evaluated)
+        break;
+
+      auto *caseIt =
+          std::find(case_values, case_values + num_cases, concreteValue);
+      Z3_solver_assert(g_context, g_solver,
+                       (caseIt == case_values + num_cases)
+                           ? anyCase
+                           : Z3_mk_not(g_context,
+                                       cases[caseIt - case_values]));
+    }
+    if (g_log != nullptr)
+      fflush(g_log);
+
+    Z3_solver_pop(g_context, g_solver, 1);
+    g_query_scheduler.recordQuery(site_id, outcome,
+                                  QueryScheduler::Clock::now() - start);
+  }
+
+  /* Assert the actual path constraint */
+  Z3_ast newConstraint = (taken_index < num_cases)
+                             ? cases[taken_index]
+                             : Z3_mk_not(g_context, anyCase);
+  Z3_inc_ref(g_context, newConstraint);
+  Z3_solver_assert(g_context, g_solver, newConstraint);
+  g_path_constraints.push_back(newConstraint);
+  assert((Z3_solver_check(g_context, g_solver) == Z3_L_TRUE) &&
+         "Asserting infeasible path constraint");
+
+  for (auto *caseTaken : cases)
+    Z3_dec_ref(g_context, caseTaken);
+  Z3_dec_ref(g_context, anyCase);
+}
+
 SymExpr _sym_concat_helper(SymExpr a, SymExpr b) {
   return registerExpression(Z3_mk_concat(g_context, a, b));
 }
@@ -506,10 +921,16 @@ size_t _sym_bits_helper(SymExpr expr) {
   return result;
 }
 
-/* No call-stack tracing */
-void _sym_notify_call(uintptr_t) {}
-void _sym_notify_ret(uintptr_t) {}
-void _sym_notify_basic_block(uintptr_t) {}
+/* Call-stack tracing (only needed for the coverage map) */
+void _sym_notify_call(uintptr_t site_id) {
+  if (g_coverage_map != nullptr)
+    g_coverage_map->enterFunction(site_id);
+}
+
+void _sym_notify_ret(uintptr_t) {
+  if (g_coverage_map != nullptr)
+    g_coverage_map->leaveFunction();
+}
 
 /* Debugging */
 const char *_sym_expr_to_string(SymExpr expr) {
@@ -563,12 +984,34 @@ void _sym_collect_garbage() {
 #endif
 }
 
+/* Persistent mode */
+void _sym_reset_backend() {
+  if (!_sym_symbolic_mode)
+    return;
+
+  for (auto *expr : allocatedExpressions)
+    Z3_dec_ref(g_context, expr);
+  allocatedExpressions.clear();
+
+  Z3_solver_reset(g_context, g_solver);
+  for (auto *constraint : g_path_constraints)
+    Z3_dec_ref(g_context, constraint);
+  g_path_constraints.clear();
+
+  // The variables are created anew when the program reads the next input.
+  for (auto *var : g_input_bytes) {
+    if (var != nullptr)
+      Z3_dec_ref(g_context, var);
+  }
+  g_input_bytes.clear();
+  g_input_values.clear();
+  g_input_file_contents.reset();
+
+  if (g_coverage_map != nullptr)
+    g_coverage_map->resetExecution();
+}
+
 /* Test-case handling */
-void symcc_set_test_case_handler(TestCaseHandler) {
-  // The simple backend doesn't support test-case handlers. However, let's not
-  // make this a fatal error; otherwise, users would have to change their
-  // programs to make them work with the simple backend.
-  fprintf(
-      g_log,
-      "Warning: test-case handlers aren't supported in the simple backend\n");
+void symcc_set_test_case_handler(TestCaseHandler handler) {
+  g_test_case_handler = handler;
 }
@@ -0,0 +1,83 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that functions dispatch to their uninstrumented clones when no
+; symbolic data can reach them. @square is pure, so it checks its argument's
+; expression; @checksum reads memory through a pointer, so it can only use its
+; clone before the program has seen symbolic input. Both are called once with
+; concrete data before the input is read, and once with symbolic data after.
+;
+; RUN: llc %s -o /dev/null
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; IR-LABEL: define{{.*}} i32 @square
+; IR: [[EXPR:%.*]] = {{.*}}call{{.*}} @_sym_get_parameter_expression(i8 0)
+; IR: icmp eq i8* [[EXPR]], null
+; IR: call{{.*}} i32 @square.symcc.concrete(
+; IR: _sym_build_mul
+define i32 @square(i32 %x) noinline {
+  %result = mul i32 %x, %x
+  ret i32 %result
+}
+
+; IR-LABEL: define{{.*}} i32 @checksum
+; IR: load i8, i8* @_sym_symbolic_mode
+; IR: call{{.*}} i32 @checksum.symcc.concrete(
+; IR: _sym_read_memory
+define i32 @checksum(i8* %data) noinline {
+  %byte = load i8, i8* %data
+  %value = zext i8 %byte to i32
+  %squared = call i32 @square(i32 %value)
+  ret i32 %squared
+}
+
+; IR-LABEL: define{{.*}} i32 @main
+; IR-NOT: symcc.concrete
+define i32 @main(i32 %argc, i8** %argv) {
+  %buffer = alloca i32
+  %bytes = bitcast i32* %buffer to i8*
+  store i32 258, i32* %buffer
+  %before = call i32 @checksum(i8* %bytes)
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %after = call i32 @checksum(i8* %bytes)
+  %sum = add i32 %before, %after
+  %cmp = icmp eq i32 %sum, 53
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin0 -> #x07
+  ; ANY: no
+  %message = select i1 %cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i8*, ...) @printf(i8* %message)
+  ret i32 0
+}
+
+; The clones don't contain any instrumentation, and they only call each other.
+; IR-LABEL: define internal{{.*}} i32 @square.symcc.concrete
+; IR-NOT: _sym_
+; IR: ret i32
+; IR-LABEL: define internal{{.*}} i32 @checksum.symcc.concrete
+; IR-NOT: _sym_
+; IR: call{{.*}} i32 @square.symcc.concrete(
+; IR-NOT: _sym_
+; IR: ret i32
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
@@ -0,0 +1,71 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that the expressions of constants are built once and cached in a
+; table that is registered with the garbage collector. The loop in @main
+; combines the symbolic input with the same constants in every iteration, so
+; all but the first iteration use the cached expressions; the solver must
+; still see the right ones.
+;
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: env SYMCC_CACHE_CONSTANTS=0 %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=NOCACHE %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+; IR: @main.symcc.constants = private global [{{[0-9]+}} x i8*] zeroinitializer
+; NOCACHE-NOT: symcc.constants
+
+@iterations = global i32 3
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; IR-LABEL: define{{.*}} i32 @main
+; IR: load i8*, i8** getelementptr{{.*}} @main.symcc.constants
+; IR: _sym_build_integer(i64 3, i8 32)
+; IR: store i8* {{.*}} @main.symcc.constants
+; IR: _sym_register_expression_region({{.*}} @main.symcc.constants
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %buffer = alloca i32
+  %bytes = bitcast i32* %buffer to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %input = load volatile i32, i32* %buffer
+  %n = load volatile i32, i32* @iterations
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %loop ]
+  %acc = phi i32 [ %input, %entry ], [ %acc.next, %loop ]
+  %scaled = mul i32 %acc, 3
+  %acc.next = add i32 %scaled, %i
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ; ((x * 3 + 0) * 3 + 1) * 3 + 2 = 27 * x + 5
+  %cmp = icmp eq i32 %acc.next, 32
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin0 -> #x01
+  ; ANY: no
+  %message = select i1 %cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i8*, ...) @printf(i8* %message)
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
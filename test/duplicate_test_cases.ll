@@ -0,0 +1,86 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that test cases are deduplicated: two branches that solve to the same
+; input yield a single test case, and with SYMCC_DEDUPLICATE_ACROSS_RUNS a
+; second execution with the same output directory yields none.
+;
+; The second comparison contradicts the path constraint of the first, so QSYM
+; solves it optimistically (i.e., without the path constraints) and arrives at
+; the same input, whereas the simple backend doesn't find a solution.
+;
+; RUN: rm -rf %t.out %t.log
+; RUN: mkdir -p %t.out
+; RUN: %symcc -O2 %s -o %t
+; RUN: /bin/echo -n x | env SYMCC_OUTPUT_DIR=%t.out SYMCC_DEDUPLICATE_ACROSS_RUNS=1 %t >> %t.log 2>&1
+; RUN: /bin/echo -n x | env SYMCC_OUTPUT_DIR=%t.out SYMCC_DEDUPLICATE_ACROSS_RUNS=1 %t >> %t.log 2>&1
+; RUN: %filecheck %s < %t.log
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+@.str.count = private unnamed_addr constant [16 x i8] c"test cases: %d\0A\00"
+
+@num_test_cases = global i32 0
+
+define void @handle_test_case(i8* %data, i64 %length) {
+  %count = load i32, i32* @num_test_cases
+  %incremented = add i32 %count, 1
+  store i32 %incremented, i32* @num_test_cases
+  ret void
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+  call void @symcc_set_test_case_handler(void (i8*, i64)* @handle_test_case)
+
+  %byte = alloca i8
+  %read = call i64 @read(i32 0, i8* %byte, i64 1)
+
+  ; The two comparisons are at different sites, so both are solved.
+  %first = load volatile i8, i8* %byte
+  %first.magic = icmp eq i8 %first, -85
+  call void @report(i1 %first.magic)
+  %second = load volatile i8, i8* %byte
+  %second.magic = icmp eq i8 %second, -85
+  call void @report(i1 %second.magic)
+
+  %count = load i32, i32* @num_test_cases
+  %printed = call i32 (i32, i8*, ...) @dprintf(i32 2, i8* getelementptr ([16 x i8], [16 x i8]* @.str.count, i64 0, i64 0), i32 %count)
+  ret i32 0
+}
+
+; First execution: the second solution (if any) is a duplicate.
+; SIMPLE: stdin0 -> #xab
+; ANY: no
+; SIMPLE: Can't find a diverging input
+; ANY: no
+; ANY: test cases: 1
+
+; Second execution: the solutions are known from the first one.
+; SIMPLE: stdin0 -> #xab
+; ANY: no
+; SIMPLE: Can't find a diverging input
+; ANY: no
+; ANY: test cases: 0
+
+define void @report(i1 %condition) noinline {
+  %message = select i1 %condition, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i32, i8*, ...) @dprintf(i32 2, i8* %message)
+  ret void
+}
+
+declare void @symcc_set_test_case_handler(void (i8*, i64)*)
+declare i64 @read(i32, i8*, i64)
+declare i32 @dprintf(i32, i8*, ...)
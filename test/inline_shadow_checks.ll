@@ -0,0 +1,75 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that loads and stores look up the shadow page table inline and only
+; call into the run-time library for memory that may be symbolic. After
+; reading symbolic input into @input, we overwrite part of it with a concrete
+; value; the inline check has to notice that the bytes are symbolic and let the
+; library make them concrete, so that only the first comparison is solved.
+;
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: env SYMCC_INLINE_SHADOW_CHECKS=0 %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=NOINLINE %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@input = global i32 0
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; IR-LABEL: define{{.*}} i32 @load
+; IR: getelementptr{{.*}} @_sym_shadow_table
+; IR: call{{.*}} @llvm.vector.reduce.or.v4i64
+; IR: call{{.*}} @_sym_read_memory
+;
+; NOINLINE-LABEL: define{{.*}} i32 @load
+; NOINLINE-NOT: _sym_shadow_table
+; NOINLINE: call{{.*}} @_sym_read_memory
+define i32 @load(i32* %pointer) noinline {
+  %value = load volatile i32, i32* %pointer
+  ret i32 %value
+}
+
+; IR-LABEL: define{{.*}} void @store
+; IR: _sym_shadow_table
+; IR: call{{.*}} @_sym_write_memory
+define void @store(i16* %pointer, i16 %value) noinline {
+  store volatile i16 %value, i16* %pointer
+  ret void
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+  %bytes = bitcast i32* @input to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %symbolic = call i32 @load(i32* @input)
+  %cmp1 = icmp eq i32 %symbolic, 42
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin0 -> #x2a
+  %low = bitcast i32* @input to i16*
+  call void @store(i16* %low, i16 5)
+  %half = call i32 @load(i32* @input)
+  %masked = and i32 %half, 65535
+  %cmp2 = icmp eq i32 %masked, 7
+  ; SIMPLE-NOT: Trying to solve
+  ; ANY: no
+  %both = or i1 %cmp1, %cmp2
+  %message = select i1 %both, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i8*, ...) @printf(i8* %message)
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
@@ -0,0 +1,74 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that test cases put the solution for each input byte at the byte's
+; offset, even if the program reads the input out of order, and that they keep
+; the bytes that the program never reads. We read offset 5 first, then seek
+; back to offset 2, which must be symbolic as well.
+;
+; RUN: rm -rf %t.out %t.log
+; RUN: mkdir -p %t.out
+; RUN: /bin/echo -ne "\x00\x00\x00\x00\x00\x07XY" > %t.input
+; RUN: %symcc -O2 %s -o %t
+; RUN: env SYMCC_INPUT_FILE=%t.input SYMCC_OUTPUT_DIR=%t.out %t %t.input >> %t.log 2>&1
+; RUN: od -An -tx1 %t.out/000000 >> %t.log
+; RUN: %filecheck %s < %t.log
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+define i32 @main(i32 %argc, i8** %argv) {
+  %byte = alloca i8
+  %name.ptr = getelementptr i8*, i8** %argv, i64 1
+  %name = load i8*, i8** %name.ptr
+  %fd = call i32 (i8*, i32, ...) @open(i8* %name, i32 0)
+
+  %pos5 = call i64 @lseek(i32 %fd, i64 5, i32 0)
+  %count5 = call i64 @read(i32 %fd, i8* %byte, i64 1)
+  %value5 = load volatile i8, i8* %byte
+  %is42 = icmp eq i8 %value5, 42
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin5 -> #x2a
+  ; ANY: no
+  call void @report(i1 %is42)
+
+  %pos2 = call i64 @lseek(i32 %fd, i64 2, i32 0)
+  %count2 = call i64 @read(i32 %fd, i8* %byte, i64 1)
+  %value2 = load volatile i8, i8* %byte
+  %is3 = icmp eq i8 %value2, 3
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin2 -> #x03
+  ; ANY: no
+  call void @report(i1 %is3)
+
+  ; The first test case (from the query at offset 5) keeps the other bytes.
+  ; SIMPLE: 00 00 00 00 00 2a 58 59
+  ; QSYM: 00 00 00 00 00 2a
+  ret i32 0
+}
+
+define void @report(i1 %condition) noinline {
+  %message = select i1 %condition, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i32, i8*, ...) @dprintf(i32 2, i8* %message)
+  ret void
+}
+
+declare i32 @open(i8*, i32, ...)
+declare i64 @lseek(i32, i64, i32)
+declare i64 @read(i32, i8*, i64)
+declare i32 @dprintf(i32, i8*, ...)
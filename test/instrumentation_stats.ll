@@ -0,0 +1,63 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that the pass reports the instrumentation of each function, and that
+; a second compilation appends to the same file.
+;
+; RUN: rm -f %t.stats
+; RUN: env SYMCC_INSTRUMENTATION_STATS=%t.stats %symcc -O2 -c %s -o %t.o
+; RUN: env SYMCC_INSTRUMENTATION_STATS=%t.stats SYMCC_MERGE_CHECKS=0 %symcc -O2 -c %s -o %t.o
+; RUN: FileCheck --check-prefix=STATS %s < %t.stats
+
+target triple = "x86_64-pc-linux-gnu"
+
+; The load's address is pinned to its concrete value, and the computations up
+; to the comparison share a check.
+; STATS: {"module":"{{.*}}instrumentation_stats.ll","function":"scale",
+; STATS-SAME: "merged_regions":1,
+; STATS-SAME: "memory_accesses":1,
+; STATS-SAME: "concretizations":1,"concrete_clone":true,
+; STATS-SAME: "runtime_calls":{
+; STATS-SAME: "_sym_build_add":1,
+; STATS-SAME: "_sym_build_mul":1,
+; STATS-SAME: "_sym_push_path_constraint":2,
+; STATS-SAME: "_sym_read_memory":1,
+; STATS-SAME: }}
+define i32 @scale(i32* %p, i32 %y) noinline {
+  %x = load i32, i32* %p
+  %product = mul i32 %x, %y
+  %sum = add i32 %product, %y
+  %cmp = icmp eq i32 %sum, 7
+  br i1 %cmp, label %seven, label %other
+
+seven:
+  ret i32 1
+
+other:
+  ret i32 %sum
+}
+
+; Indirect calls may lead anywhere, so there is no clone, and the target
+; address is pinned to its concrete value.
+; STATS: {"module":"{{.*}}instrumentation_stats.ll","function":"indirect",
+; STATS-SAME: "concretizations":1,"concrete_clone":false,
+define i32 @indirect(i32 ()* %callee) {
+  %result = call i32 %callee()
+  ret i32 %result
+}
+
+; Without merged checks, the second compilation reports no regions.
+; STATS: {"module":"{{.*}}instrumentation_stats.ll","function":"scale",
+; STATS-SAME: "merged_regions":0,"merged_computations":0,
+; STATS: "function":"indirect"
@@ -0,0 +1,75 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that a chain of arithmetic is guarded by a single check for the
+; expressions of its inputs before any of the chain's computations runs. The
+; computations keep their own checks inside the region, so the chain still
+; produces the right expression if only %y is symbolic.
+;
+; RUN: env SYMCC_OPTIMIZE_INSTRUMENTATION=0 SYMCC_CONCRETE_CLONES=0 %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: env SYMCC_MERGE_CHECKS=0 SYMCC_OPTIMIZE_INSTRUMENTATION=0 SYMCC_CONCRETE_CLONES=0 %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=NOMERGE %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; IR-LABEL: define{{.*}} i32 @chain
+; IR: [[X:%.*]] = call{{.*}} @_sym_get_parameter_expression(i8 0)
+; IR: [[Y:%.*]] = call{{.*}} @_sym_get_parameter_expression(i8 1)
+; IR-NOT: _sym_build
+; IR: icmp eq i8* null, [[X]]
+; IR-NEXT: icmp eq i8* null, [[Y]]
+; IR-NEXT: and i1
+; IR-NEXT: br i1
+; IR: _sym_build_mul
+; IR: _sym_build_add
+; IR: _sym_build_xor
+; IR: phi i8* [ null, %{{.*}} ], [ %{{.*}}, %{{.*}} ]
+; IR: ret i32
+;
+; NOMERGE-LABEL: define{{.*}} i32 @chain
+; NOMERGE: [[Y:%.*]] = call{{.*}} @_sym_get_parameter_expression(i8 1)
+; NOMERGE-NOT: icmp eq i8* null, [[Y]]
+; NOMERGE: _sym_build_mul
+; NOMERGE: icmp eq i8* null, [[Y]]
+; NOMERGE: _sym_build_add
+define i32 @chain(i32 %x, i32 %y) noinline {
+  %a = mul i32 %x, 3
+  %b = add i32 %a, %y
+  %c = xor i32 %b, 5
+  ret i32 %c
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+  %buffer = alloca i32
+  %bytes = bitcast i32* %buffer to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %input = load i32, i32* %buffer
+  ; Only the second argument is symbolic.
+  %result = call i32 @chain(i32 1, i32 %input)
+  %cmp = icmp eq i32 %result, 14
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin0 -> #x08
+  ; ANY: no
+  %message = select i1 %cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i8*, ...) @printf(i8* %message)
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
@@ -0,0 +1,65 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that we optimize the code after instrumenting it. Each computation in
+; @combine checks on its own whether the expression of %x is null; the
+; optimizations that run after instrumentation leave a single check, whereas
+; the unoptimized instrumentation keeps all three.
+;
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: env SYMCC_OPTIMIZE_INSTRUMENTATION=0 SYMCC_CONCRETE_CLONES=0 %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=NOOPT %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; IR-LABEL: define{{.*}} i32 @combine
+; IR: [[EXPR:%.*]] = {{.*}}call{{.*}} @_sym_get_parameter_expression(i8 0)
+; IR: icmp eq i8* [[EXPR]], null
+; IR-NOT: icmp eq i8* [[EXPR]], null
+; IR: ret i32
+;
+; NOOPT-LABEL: define{{.*}} i32 @combine
+; NOOPT: [[EXPR:%.*]] = {{.*}}call{{.*}} @_sym_get_parameter_expression(i8 0)
+; NOOPT-COUNT-3: icmp eq i8* {{(null, )?}}[[EXPR]]
+; NOOPT: ret i32
+define i32 @combine(i32 %x) noinline {
+  %a = add i32 %x, 1
+  %b = mul i32 %x, 3
+  %c = sub i32 %x, 5
+  %ab = xor i32 %a, %b
+  %result = xor i32 %ab, %c
+  ret i32 %result
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+  %buffer = alloca i32
+  %bytes = bitcast i32* %buffer to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %x = load i32, i32* %buffer
+  %combined = call i32 @combine(i32 %x)
+  %cmp = icmp eq i32 %combined, 31
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; ANY: no
+  %message = select i1 %cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i8*, ...) @printf(i8* %message)
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
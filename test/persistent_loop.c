@@ -0,0 +1,55 @@
+// This file is part of SymCC.
+//
+// SymCC is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+// RUN: %symcc -O2 %s -o %t
+// RUN: env SYMCC_MEMORY_INPUT=1 %t 2>&1 | %filecheck %s
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+void symcc_make_symbolic(const void *start, size_t byte_length);
+int symcc_persistent_loop(unsigned int max_iterations);
+
+int main(int argc, char *argv[]) {
+  int iterations = 0;
+
+  while (symcc_persistent_loop(2)) {
+    uint8_t x = iterations;
+    symcc_make_symbolic(&x, sizeof(x));
+
+    // Each iteration starts over with fresh input and no path constraints.
+    fprintf(stderr, "%s\n", (x == 42) ? "yes" : "no");
+    // SIMPLE: Trying to solve
+    // SIMPLE-NOT: assert
+    // SIMPLE: (assert (= stdin0 #x2a))
+    // SIMPLE-NOT: assert
+    // SIMPLE: Found diverging input
+    // SIMPLE: stdin0 -> #x2a
+    // ANY: no
+    // SIMPLE: Trying to solve
+    // SIMPLE-NOT: assert
+    // SIMPLE: (assert (= stdin0 #x2a))
+    // SIMPLE-NOT: assert
+    // SIMPLE: Found diverging input
+    // SIMPLE: stdin0 -> #x2a
+    // ANY: no
+
+    iterations++;
+  }
+
+  fprintf(stderr, "%d iterations\n", iterations);
+  // ANY: 2 iterations
+
+  return 0;
+}
@@ -0,0 +1,62 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that the static taint analysis removes instrumentation from code that
+; never sees symbolic data. The function @scale is only ever called with
+; main's argc, so neither its computation nor its result need expressions;
+; the sum of its result and the input, however, is symbolic.
+;
+; RUN: llc %s -o /dev/null
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; IR-LABEL: define internal{{.*}} @scale
+; IR-NOT: _sym_get_parameter_expression
+; IR-NOT: _sym_build_mul
+; IR: ret i32
+define internal i32 @scale(i32 %x) noinline {
+  %result = mul i32 %x, 3
+  ret i32 %result
+}
+
+; IR-LABEL: define{{.*}} i32 @main
+define i32 @main(i32 %argc, i8** %argv) {
+  %buffer = alloca i32
+  %bytes = bitcast i32* %buffer to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %input = load i32, i32* %buffer
+
+  ; IR: call{{.*}} i32 @scale
+  ; IR-NOT: _sym_get_return_expression
+  ; IR: _sym_build_add
+  %scaled = call i32 @scale(i32 %argc)
+  %sum = add i32 %input, %scaled
+  %cmp = icmp eq i32 %sum, 42
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin0 -> #x27
+  ; ANY: no
+  %message = select i1 %cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %printed = call i32 (i8*, ...) @printf(i8* %message)
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
@@ -0,0 +1,60 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that a switch over a Boolean pushes a path constraint per case instead
+; of handing the run-time library a table of integers, which it can't compare
+; with the Boolean's expression. Optimization would turn the switch into a
+; branch, so we compile without it.
+;
+; RUN: %symcc -O0 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: %symcc -O0 %s -o %t
+; RUN: echo -ne "\x05" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.odd = private unnamed_addr constant [5 x i8] c"odd\0A\00"
+@.str.even = private unnamed_addr constant [6 x i8] c"even\0A\00"
+
+; IR-LABEL: define{{.*}} i32 @main
+; IR-NOT: _sym_push_switch_constraint
+; IR: call void @_sym_push_path_constraint(
+; IR-NOT: _sym_push_switch_constraint
+; IR: ret i32
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %byte = alloca i8
+  %count = call i64 @read(i32 0, i8* %byte, i64 1)
+  %value = load i8, i8* %byte
+  %odd = trunc i8 %value to i1
+  switch i1 %odd, label %even [
+    i1 true, label %isodd
+  ]
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; ANY: odd
+
+isodd:
+  %po = call i32 (i8*, ...) @printf(i8* getelementptr ([5 x i8], [5 x i8]* @.str.odd, i64 0, i64 0))
+  br label %exit
+
+even:
+  %pe = call i32 (i8*, ...) @printf(i8* getelementptr ([6 x i8], [6 x i8]* @.str.even, i64 0, i64 0))
+  br label %exit
+
+exit:
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
@@ -0,0 +1,76 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that a switch hands all of its cases to the run-time library at once,
+; and that the simple backend finds inputs for all alternatives (the other two
+; cases and the default) in a single solver session.
+;
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+; IR: @main.symcc.cases = private unnamed_addr constant [3 x i64] [i64 3, i64 4, i64 5]
+
+@.str.three = private unnamed_addr constant [11 x i8] c"x is three\00"
+@.str.five = private unnamed_addr constant [9 x i8] c"x is %d\0A\00"
+@.str.other = private unnamed_addr constant [20 x i8] c"x is something else\00"
+
+; IR-LABEL: define{{.*}} i32 @main
+; IR-NOT: _sym_push_path_constraint
+; IR: call void @_sym_push_switch_constraint({{.*}} @main.symcc.cases, i64 0, i64 0), i64 3, i64 %{{[0-9]+}}, i64
+; IR-NOT: _sym_push_path_constraint
+; IR: ret i32
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %buffer = alloca i32
+  %bytes = bitcast i32* %buffer to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %x = load i32, i32* %buffer
+  switch i32 %x, label %other [
+    i32 3, label %three
+    i32 4, label %four
+    i32 5, label %five
+  ]
+  ; SIMPLE: Trying to solve
+  ; SIMPLE-COUNT-3: Found diverging input
+  ; SIMPLE-NOT: Trying to solve
+  ; ANY: x is 5
+
+three:
+  %p3 = call i32 @puts(i8* getelementptr ([11 x i8], [11 x i8]* @.str.three, i64 0, i64 0))
+  br label %exit
+
+four:
+  %p4 = call i32 @putchar(i32 52)
+  %n4 = call i32 @putchar(i32 10)
+  br label %exit
+
+five:
+  %p5 = call i32 (i8*, ...) @printf(i8* getelementptr ([9 x i8], [9 x i8]* @.str.five, i64 0, i64 0), i32 %x)
+  br label %exit
+
+other:
+  %po = call i32 @puts(i8* getelementptr ([20 x i8], [20 x i8]* @.str.other, i64 0, i64 0))
+  br label %exit
+
+exit:
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
+declare i32 @puts(i8*)
+declare i32 @putchar(i32)
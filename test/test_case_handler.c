@@ -35,7 +35,6 @@ void handle_test_case(const void *data, size_t data_length) {
 
 int main(int argc, char *argv[]) {
   symcc_set_test_case_handler(handle_test_case);
-  // SIMPLE: Warning: test-case handlers
 
   uint8_t input = 0;
   symcc_make_symbolic(&input, sizeof(input));
@@ -48,12 +47,10 @@ int main(int argc, char *argv[]) {
   // ANY: no
 
   fprintf(stderr, "%d\n", solved);
-  // QSYM: 1
-  // SIMPLE: 0
+  // ANY: 1
 
   fprintf(stderr, "%d\n", num_test_cases);
-  // QSYM: 1
-  // SIMPLE: 0
+  // ANY: 1
 
   return 0;
 }
@@ -0,0 +1,93 @@
+; This file is part of SymCC.
+;
+; SymCC is free software: you can redistribute it and/or modify it under the
+; terms of the GNU General Public License as published by the Free Software
+; Foundation, either version 3 of the License, or (at your option) any later
+; version.
+;
+; SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+; WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+; A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License along with
+; SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+; Verify that we track symbolic data through vector instructions, which are
+; common in code that the optimizer has vectorized. The input is loaded as a
+; vector of four bytes and goes through element-wise operations, shuffles,
+; insertions and extractions, a bit mask, and a reduction.
+;
+; RUN: %symcc -O2 %s -S -emit-llvm -o - | FileCheck --check-prefix=IR %s
+; RUN: %symcc -O2 %s -o %t
+; RUN: echo -ne "\x05\x00\x00\x00" | %t 2>&1 | %filecheck %s
+
+target triple = "x86_64-pc-linux-gnu"
+
+@.str.yes = private unnamed_addr constant [5 x i8] c"yes\0A\00"
+@.str.no = private unnamed_addr constant [4 x i8] c"no\0A\00"
+
+; Returns <7, b2 + 3, b1 + 2, b0 + 1>.
+;
+; IR-LABEL: define{{.*}} <4 x i32> @widen
+; IR-DAG: ret <4 x i32>
+; IR: call{{.*}} @_sym_build_zext
+; IR: call{{.*}} @_sym_build_add
+; IR: call{{.*}} @_sym_concat_helper
+; IR: call void @_sym_set_return_expression
+define <4 x i32> @widen(<4 x i8> %v) noinline {
+  %wide = zext <4 x i8> %v to <4 x i32>
+  %sum = add <4 x i32> %wide, <i32 1, i32 2, i32 3, i32 4>
+  %reversed = shufflevector <4 x i32> %sum, <4 x i32> undef, <4 x i32> <i32 3, i32 2, i32 1, i32 0>
+  %result = insertelement <4 x i32> %reversed, i32 7, i32 0
+  ret <4 x i32> %result
+}
+
+; Returns a bit mask of the input bytes greater than 4.
+;
+; IR-LABEL: define{{.*}} i32 @mask
+; IR: call{{.*}} @_sym_build_unsigned_greater_than
+; IR: call{{.*}} @_sym_build_trunc
+define i32 @mask(<4 x i8> %v) noinline {
+  %greater = icmp ugt <4 x i8> %v, <i8 4, i8 4, i8 4, i8 4>
+  %bits = bitcast <4 x i1> %greater to i4
+  %result = zext i4 %bits to i32
+  ret i32 %result
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+  %buffer = alloca <4 x i8>
+  %bytes = bitcast <4 x i8>* %buffer to i8*
+  %count = call i64 @read(i32 0, i8* %bytes, i64 4)
+  %input = load <4 x i8>, <4 x i8>* %buffer
+  %widened = call <4 x i32> @widen(<4 x i8> %input)
+
+  %last = extractelement <4 x i32> %widened, i32 3
+  %last.cmp = icmp eq i32 %last, 42
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  ; SIMPLE: stdin0 -> #x29
+  %last.message = select i1 %last.cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %last.printed = call i32 (i8*, ...) @printf(i8* %last.message)
+
+  %mask = call i32 @mask(<4 x i8> %input)
+  %mask.cmp = icmp eq i32 %mask, 3
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  %mask.message = select i1 %mask.cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %mask.printed = call i32 (i8*, ...) @printf(i8* %mask.message)
+
+  %sum = call i32 @llvm.vector.reduce.add.v4i32(<4 x i32> %widened)
+  %sum.cmp = icmp eq i32 %sum, 100
+  ; SIMPLE: Trying to solve
+  ; SIMPLE: Found diverging input
+  %sum.message = select i1 %sum.cmp, i8* getelementptr ([5 x i8], [5 x i8]* @.str.yes, i64 0, i64 0), i8* getelementptr ([4 x i8], [4 x i8]* @.str.no, i64 0, i64 0)
+  %sum.printed = call i32 (i8*, ...) @printf(i8* %sum.message)
+  ; ANY: no
+  ; ANY: no
+  ; ANY: no
+  ret i32 0
+}
+
+declare i64 @read(i32, i8*, i64)
+declare i32 @printf(i8*, ...)
+declare i32 @llvm.vector.reduce.add.v4i32(<4 x i32>)
@@ -0,0 +1,617 @@
+// This file is part of SymCC.
+//
+// SymCC is free software: you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// SymCC is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+// A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// SymCC. If not, see <https://www.gnu.org/licenses/>.
+
+// A driver for pure concolic execution: run a SymCC-instrumented program on a
+// corpus of inputs, feeding the newly generated inputs back into it, with
+// several executions in parallel. This is the native counterpart of
+// util/pure_concolic_execution.sh.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// How often we look for new files in the input directory.
+constexpr auto kImportInterval = std::chrono::seconds(5);
+
+struct Options {
+  std::string inputDir;
+  std::string outputDir;
+  std::string failedDir;
+  unsigned workers = 1;
+  unsigned timeout = 90;
+  bool prune = false;
+  std::vector<std::string> target;
+};
+
+/// An input waiting to be analyzed.
+struct Input {
+  std::string data;
+
+  /// The number of previously unseen inputs per second that the execution
+  /// producing this input generated (infinite for initial inputs).
+  double parentYield;
+
+  /// The number of executions between an initial input and this one.
+  unsigned generation;
+
+  /// The order in which inputs were discovered, for tie breaking.
+  uint64_t sequence;
+};
+
+/// Order inputs by priority for std::priority_queue (which returns the
+/// largest element first).
+///
+/// Inputs whose parent produced many new inputs quickly are likely to lie in
+/// productive parts of the program; among equally productive ones, we prefer
+/// shallower and older inputs, so that exploration stays broad.
+struct InputPriority {
+  bool operator()(const Input &a, const Input &b) const {
+    if (a.parentYield != b.parentYield)
+      return a.parentYield < b.parentYield;
+    if (a.generation != b.generation)
+      return a.generation > b.generation;
+    return a.sequence > b.sequence;
+  }
+};
+
+/// A slot for one concurrent execution of the target.
+struct Worker {
+  /// The directory containing this worker's input file and output directory.
+  std::string directory;
+
+  /// The running target, or 0 if the worker is idle.
+  pid_t pid = 0;
+
+  /// The input being analyzed.
+  Input input;
+
+  Clock::time_point start;
+
+  std::string inputFile() const { return directory + "/input"; }
+  std::string outputDir() const { return directory + "/out"; }
+};
+
+[[noreturn]] void fail(const std::string &what) {
+  std::cerr << "Error: failed to " << what << ": " << strerror(errno)
+            << std::endl;
+  exit(1);
+}
+
+void usage(const char *program) {
+  std::cerr
+      << "Usage: " << program
+      << " -i INPUT_DIR [-o OUTPUT_DIR] [-f FAILED_DIR] [-j WORKERS]\n"
+         "       [-t TIMEOUT] [-p] TARGET...\n"
+         "\n"
+         "Run SymCC-instrumented TARGET on the inputs in INPUT_DIR, feeding\n"
+         "newly generated inputs back into it, with WORKERS executions in\n"
+         "parallel (default: the number of CPUs). New files in INPUT_DIR are\n"
+         "picked up continuously. If OUTPUT_DIR is specified, each generated\n"
+         "input is preserved there. If FAILED_DIR is specified, inputs on\n"
+         "which the target fails are preserved there. Executions are killed\n"
+         "after TIMEOUT seconds (default: 90). TARGET may contain the special\n"
+         "string \"@@\", which is replaced with the name of the current input\n"
+         "file.\n"
+         "\n"
+         "With -p, executions share a coverage map and skip branches that\n"
+         "another execution has already explored (see SYMCC_AFL_COVERAGE_SHM).\n"
+         "The QSYM backend doesn't synchronize its updates to the map, so we\n"
+         "run a single execution at a time in this case.\n"
+         "\n"
+         "Note that SymCC never changes the length of the input, so be sure\n"
+         "that the initial inputs cover all required input lengths.\n";
+}
+
+unsigned parseUnsigned(const char *value, const char *description) {
+  char *end;
+  errno = 0;
+  auto result = strtoul(value, &end, 10);
+  if (errno != 0 || *end != '\0' || result == 0 ||
+      result > std::numeric_limits<unsigned>::max()) {
+    std::cerr << "Error: the " << description << " must be a positive integer"
+              << std::endl;
+    exit(1);
+  }
+
+  return result;
+}
+
+Options parseOptions(int argc, char *argv[]) {
+  Options options;
+  options.workers = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+
+  int opt;
+  while ((opt = getopt(argc, argv, "+i:o:f:j:t:ph")) != -1) {
+    switch (opt) {
+    case 'i':
+      options.inputDir = optarg;
+      break;
+    case 'o':
+      options.outputDir = optarg;
+      break;
+    case 'f':
+      options.failedDir = optarg;
+      break;
+    case 'j':
+      options.workers = parseUnsigned(optarg, "number of workers");
+      break;
+    case 't':
+      options.timeout = parseUnsigned(optarg, "timeout");
+      break;
+    case 'p':
+      options.prune = true;
+      break;
+    case 'h':
+      usage(argv[0]);
+      exit(0);
+    default:
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  options.target.assign(argv + optind, argv + argc);
+  if (options.inputDir.empty() || options.target.empty()) {
+    std::cerr << "Please specify the input directory and the target!"
+              << std::endl;
+    usage(argv[0]);
+    exit(1);
+  }
+
+  return options;
+}
+
+/// List the regular files in the given directory.
+std::vector<std::string> listFiles(const std::string &directory) {
+  std::vector<std::string> files;
+  auto *dir = opendir(directory.c_str());
+  if (dir == nullptr)
+    fail("open the directory " + directory);
+
+  while (auto *entry = readdir(dir)) {
+    auto path = directory + "/" + entry->d_name;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+      files.push_back(std::move(path));
+  }
+
+  closedir(dir);
+  return files;
+}
+
+void removeDirectory(const std::string &directory) {
+  auto *dir = opendir(directory.c_str());
+  if (dir == nullptr)
+    return;
+
+  while (auto *entry = readdir(dir)) {
+    std::string_view name = entry->d_name;
+    if (name == "." || name == "..")
+      continue;
+
+    auto path = directory + "/" + entry->d_name;
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+      removeDirectory(path);
+    else
+      unlink(path.c_str());
+  }
+
+  closedir(dir);
+  rmdir(directory.c_str());
+}
+
+void createDirectory(const std::string &directory) {
+  if (mkdir(directory.c_str(), 0755) == -1 && errno != EEXIST)
+    fail("create the directory " + directory);
+}
+
+std::string readFile(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string &path, const std::string &data) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(data.data(), data.size());
+  if (!file)
+    fail("write " + path);
+}
+
+size_t hashInput(const std::string &data) {
+  return std::hash<std::string_view>{}(data);
+}
+
+/// Name a file after the hash of its contents, like the shell script does.
+std::string uniqueName(size_t hash) {
+  std::stringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return name.str();
+}
+
+/// Find out whether the target was built with the QSYM backend by running it
+/// once without symbolic input and looking for the backend's banner (like the
+/// fuzzing helper does).
+bool usesQsymBackend(const Options &options, const std::string &inputFile) {
+  writeFile(inputFile, "");
+
+  bool useStandardInput = true;
+  std::vector<std::string> arguments = options.target;
+  for (auto &argument : arguments) {
+    if (argument == "@@") {
+      argument = inputFile;
+      useStandardInput = false;
+    }
+  }
+
+  int pipeFds[2];
+  if (pipe(pipeFds) == -1)
+    fail("create a pipe");
+
+  pid_t pid = fork();
+  if (pid == -1)
+    fail("fork");
+
+  if (pid == 0) {
+    setenv("SYMCC_NO_SYMBOLIC_INPUT", "1", 1);
+    unsetenv("SYMCC_AFL_COVERAGE_SHM");
+
+    int input = useStandardInput ? open(inputFile.c_str(), O_RDONLY)
+                                 : open("/dev/null", O_RDONLY);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (input == -1 || devNull == -1 || dup2(input, STDIN_FILENO) == -1 ||
+        dup2(devNull, STDOUT_FILENO) == -1 ||
+        dup2(pipeFds[1], STDERR_FILENO) == -1)
+      _exit(127);
+    close(pipeFds[0]);
+
+    // The alarm survives execvp and terminates a target that hangs.
+    alarm(options.timeout);
+
+    std::vector<char *> argv;
+    for (auto &argument : arguments)
+      argv.push_back(argument.data());
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+
+  close(pipeFds[1]);
+  std::string output;
+  char buffer[4096];
+  ssize_t length;
+  while ((length = read(pipeFds[0], buffer, sizeof(buffer))) != 0) {
+    if (length == -1) {
+      if (errno == EINTR)
+        continue;
+      fail("read the output of the target");
+    }
+    output.append(buffer, length);
+  }
+  close(pipeFds[0]);
+  waitpid(pid, nullptr, 0);
+
+  return output.find("with the QSYM backend") != std::string::npos;
+}
+
+class Driver {
+public:
+  explicit Driver(Options options);
+  ~Driver();
+
+  /// Run until we're interrupted.
+  void run();
+
+private:
+  /// Queue the files in the input directory that we haven't seen yet.
+  void importInputs();
+
+  /// Start analyzing the most promising input in the given worker.
+  void startWorker(Worker &worker);
+
+  /// Process the results of a finished execution.
+  void finishWorker(Worker &worker, int status);
+
+  /// Queue an input unless we've seen it before; return true if it's new.
+  bool addInput(std::string data, double parentYield, unsigned generation);
+
+  Options options;
+
+  /// The temporary directory containing the workers' files.
+  std::string workDir;
+
+  /// The name of the shared-memory coverage map (see SYMCC_AFL_COVERAGE_SHM),
+  /// used only if we prune.
+  std::string coverageMap;
+
+  std::vector<Worker> workers;
+  std::priority_queue<Input, std::vector<Input>, InputPriority> queue;
+
+  /// The hashes of all inputs that we have queued so far.
+  std::unordered_set<size_t> seen;
+
+  /// The files from the input directory that we have already imported.
+  std::unordered_set<std::string> imported;
+
+  uint64_t nextSequence = 0;
+
+  /// The number of finished executions.
+  uint64_t executions = 0;
+
+  /// The signals that we handle synchronously in the main loop.
+  sigset_t signals;
+  sigset_t originalSignalMask;
+};
+
+Driver::Driver(Options opts) : options(std::move(opts)) {
+  char workDirTemplate[] = "/tmp/symcc_driver_XXXXXX";
+  if (mkdtemp(workDirTemplate) == nullptr)
+    fail("create a working directory");
+  workDir = workDirTemplate;
+
+  coverageMap = "/symcc-driver-" + std::to_string(getpid());
+
+  if (!options.outputDir.empty())
+    createDirectory(options.outputDir);
+  if (!options.failedDir.empty())
+    createDirectory(options.failedDir);
+
+  if (options.prune && options.workers > 1 &&
+      usesQsymBackend(options, workDir + "/probe")) {
+    std::cerr << "Warning: the target uses the QSYM backend, which doesn't "
+                 "support concurrent updates to the shared coverage map; "
+                 "running a single execution at a time"
+              << std::endl;
+    options.workers = 1;
+  }
+
+  workers.resize(options.workers);
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].directory = workDir + "/worker" + std::to_string(i);
+    createDirectory(workers[i].directory);
+    createDirectory(workers[i].outputDir());
+  }
+
+  // We wait for children and termination requests with sigtimedwait, so the
+  // signals must not be delivered asynchronously.
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGCHLD);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigprocmask(SIG_BLOCK, &signals, &originalSignalMask);
+}
+
+Driver::~Driver() {
+  for (auto &worker : workers) {
+    if (worker.pid != 0) {
+      kill(worker.pid, SIGKILL);
+      waitpid(worker.pid, nullptr, 0);
+    }
+  }
+
+  removeDirectory(workDir);
+  if (options.prune)
+    shm_unlink(coverageMap.c_str());
+}
+
+bool Driver::addInput(std::string data, double parentYield,
+                      unsigned generation) {
+  if (!seen.insert(hashInput(data)).second)
+    return false;
+
+  queue.push({std::move(data), parentYield, generation, nextSequence++});
+  return true;
+}
+
+void Driver::importInputs() {
+  for (auto &path : listFiles(options.inputDir)) {
+    if (!imported.insert(path).second)
+      continue;
+
+    if (addInput(readFile(path), std::numeric_limits<double>::infinity(), 0))
+      std::cout << "Importing " << path << " from the input directory"
+                << std::endl;
+  }
+}
+
+void Driver::startWorker(Worker &worker) {
+  worker.input = queue.top();
+  queue.pop();
+  writeFile(worker.inputFile(), worker.input.data);
+
+  bool useStandardInput = true;
+  std::vector<std::string> arguments = options.target;
+  for (auto &argument : arguments) {
+    if (argument == "@@") {
+      argument = worker.inputFile();
+      useStandardInput = false;
+    }
+  }
+
+  worker.start = Clock::now();
+  worker.pid = fork();
+  if (worker.pid == -1)
+    fail("fork");
+
+  if (worker.pid == 0) {
+    sigprocmask(SIG_SETMASK, &originalSignalMask, nullptr);
+
+    setenv("SYMCC_OUTPUT_DIR", worker.outputDir().c_str(), 1);
+    setenv("SYMCC_ENABLE_LINEARIZATION", "1", 1);
+    if (options.prune)
+      setenv("SYMCC_AFL_COVERAGE_SHM", coverageMap.c_str(), 1);
+    if (!useStandardInput)
+      setenv("SYMCC_INPUT_FILE", worker.inputFile().c_str(), 1);
+
+    int input = useStandardInput ? open(worker.inputFile().c_str(), O_RDONLY)
+                                 : open("/dev/null", O_RDONLY);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (input == -1 || devNull == -1 || dup2(input, STDIN_FILENO) == -1 ||
+        dup2(devNull, STDOUT_FILENO) == -1 ||
+        dup2(devNull, STDERR_FILENO) == -1)
+      _exit(127);
+
+    std::vector<char *> argv;
+    for (auto &argument : arguments)
+      argv.push_back(argument.data());
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+}
+
+void Driver::finishWorker(Worker &worker, int status) {
+  worker.pid = 0;
+  std::chrono::duration<double> elapsed = Clock::now() - worker.start;
+
+  std::vector<std::string> generated;
+  for (auto &path : listFiles(worker.outputDir())) {
+    generated.push_back(readFile(path));
+    unlink(path.c_str());
+  }
+
+  // The yield counts only inputs that we haven't seen before, so that
+  // executions repeating known results don't get their children prioritized.
+  std::vector<std::string> fresh;
+  for (auto &data : generated) {
+    if (seen.count(hashInput(data)) == 0 &&
+        std::find(fresh.begin(), fresh.end(), data) == fresh.end())
+      fresh.push_back(std::move(data));
+  }
+
+  auto yield = fresh.size() / std::max(elapsed.count(), 0.001);
+  for (auto &data : fresh) {
+    if (!options.outputDir.empty())
+      writeFile(options.outputDir + "/" + uniqueName(hashInput(data)), data);
+    addInput(std::move(data), yield, worker.input.generation + 1);
+  }
+
+  bool failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+  if (failed && !options.failedDir.empty())
+    writeFile(options.failedDir + "/" +
+                  uniqueName(hashInput(worker.input.data)),
+              worker.input.data);
+
+  executions++;
+  std::cout << "Execution " << executions << " (generation "
+            << worker.input.generation << "): " << fresh.size()
+            << " new inputs out of " << generated.size() << " in "
+            << std::fixed << std::setprecision(2) << elapsed.count() << "s"
+            << (failed ? ", target failed" : "") << "; " << queue.size()
+            << " inputs queued" << std::endl;
+}
+
+void Driver::run() {
+  importInputs();
+  auto lastImport = Clock::now();
+  bool waiting = false;
+
+  while (true) {
+    for (auto &worker : workers) {
+      if (worker.pid == 0 && !queue.empty())
+        startWorker(worker);
+    }
+
+    // Wake up when the next execution times out or when it's time to look for
+    // new inputs, whichever comes first.
+    auto now = Clock::now();
+    auto wakeUp = lastImport + kImportInterval;
+    bool busy = false;
+    for (auto &worker : workers) {
+      if (worker.pid == 0)
+        continue;
+
+      busy = true;
+      wakeUp = std::min(wakeUp, worker.start +
+                                    std::chrono::seconds(options.timeout));
+    }
+
+    if (!busy && !waiting) {
+      std::cout << "Waiting for more input..." << std::endl;
+      waiting = true;
+    }
+
+    auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::max(wakeUp - now, Clock::duration::zero()));
+    timespec timeout{
+        static_cast<time_t>(delay.count() / 1'000'000'000),
+        static_cast<long>(delay.count() % 1'000'000'000)};
+    int signal = sigtimedwait(&signals, nullptr, &timeout);
+    if (signal == -1 && errno != EAGAIN && errno != EINTR)
+      fail("wait for the workers");
+    if (signal == SIGINT || signal == SIGTERM)
+      return;
+
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+      for (auto &worker : workers) {
+        if (worker.pid == pid)
+          finishWorker(worker, status);
+      }
+    }
+
+    // Timed-out executions are reaped in the next iteration.
+    now = Clock::now();
+    for (auto &worker : workers) {
+      if (worker.pid != 0 &&
+          now - worker.start >= std::chrono::seconds(options.timeout))
+        kill(worker.pid, SIGKILL);
+    }
+
+    if (now - lastImport >= kImportInterval) {
+      importInputs();
+      lastImport = now;
+    }
+
+    if (!queue.empty())
+      waiting = false;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Driver driver(parseOptions(argc, argv));
+  driver.run();
+  return 0;
+}
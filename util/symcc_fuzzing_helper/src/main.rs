@@ -21,9 +21,12 @@ use std::fs;
 use std::fs::File;
 use std::io::Write;
 use std::path::{Path, PathBuf};
+use std::sync::{mpsc, Arc, Mutex};
 use std::thread;
 use std::time::{Duration, Instant};
-use symcc::{AflConfig, AflMap, AflShowmapResult, SymCC, TestcaseDir};
+use symcc::{
+    AflConfig, AflCoverageChecker, AflMap, AflShowmapResult, SharedCoverageMap, SymCC, TestcaseDir,
+};
 use tempfile::tempdir;
 
 const STATS_INTERVAL_SEC: u64 = 60;
@@ -50,6 +53,19 @@ struct CLI {
     #[clap(short = 'v')]
     verbose: bool,
 
+    /// Run the target as a fork server (see SYMCC_FORK_SERVER)
+    #[clap(short = 'f')]
+    fork_server: bool,
+
+    /// Start the fork server after this many input bytes (see
+    /// SYMCC_SNAPSHOT_OFFSET)
+    #[clap(short = 's', default_value = "0")]
+    snapshot_offset: u32,
+
+    /// Number of concurrent SymCC executions
+    #[clap(short = 'j', default_value = "1")]
+    jobs: usize,
+
     /// Program under test
     command: Vec<String>,
 }
@@ -161,7 +177,8 @@ struct State {
     /// The cumulative coverage of all test cases generated so far.
     current_bitmap: AflMap,
 
-    /// The AFL test cases that have been analyzed so far.
+    /// The AFL test cases that have been analyzed so far or are being analyzed
+    /// by one of the workers.
     processed_files: HashSet<PathBuf>,
 
     /// The place to put new and useful test cases.
@@ -212,54 +229,104 @@ impl State {
         })
     }
 
-    /// Run a single input through SymCC and process the new test cases it
-    /// generates.
-    fn test_input(
-        &mut self,
-        input: impl AsRef<Path>,
-        symcc: &SymCC,
-        afl_config: &AflConfig,
-    ) -> Result<()> {
-        log::info!("Running on input {}", input.as_ref().display());
-
-        let tmp_dir = tempdir()
-            .context("Failed to create a temporary directory for this execution of SymCC")?;
-
-        let mut num_interesting = 0u64;
-        let mut num_total = 0u64;
-
-        let symcc_result = symcc
-            .run(&input, tmp_dir.path().join("output"))
-            .context("Failed to run SymCC")?;
-        for new_test in symcc_result.test_cases.iter() {
-            let res = process_new_testcase(&new_test, &input, &tmp_dir, &afl_config, self)?;
-
-            num_total += 1;
-            if res == TestcaseResult::New {
-                log::debug!("Test case is interesting");
-                num_interesting += 1;
+    /// Write the statistics to the stats file if it's time to do so.
+    fn maybe_log_stats(&mut self) {
+        if self.last_stats_output.elapsed().as_secs() > STATS_INTERVAL_SEC {
+            if let Err(e) = self.stats.log(&mut self.stats_file) {
+                log::error!("Failed to log run-time statistics: {}", e);
             }
+            self.last_stats_output = Instant::now();
         }
+    }
+}
+
+/// Run a single input through SymCC and process the new test cases it
+/// generates.
+///
+/// The state is only locked while we update it, so that several workers can
+/// run SymCC and the AFL target at the same time.
+fn test_input(
+    input: impl AsRef<Path>,
+    symcc: &mut SymCC,
+    checker: &mut AflCoverageChecker,
+    afl_config: &AflConfig,
+    state: &Mutex<State>,
+) -> Result<()> {
+    log::info!("Running on input {}", input.as_ref().display());
+
+    let tmp_dir = tempdir()
+        .context("Failed to create a temporary directory for this execution of SymCC")?;
+
+    let mut num_interesting = 0u64;
+    let mut num_total = 0u64;
+
+    let symcc_result = symcc
+        .run(&input, tmp_dir.path().join("output"))
+        .context("Failed to run SymCC")?;
+    for new_test in symcc_result.test_cases.iter() {
+        let res = process_new_testcase(&new_test, &input, &tmp_dir, checker, &afl_config, state)?;
+
+        num_total += 1;
+        if res == TestcaseResult::New {
+            log::debug!("Test case is interesting");
+            num_interesting += 1;
+        }
+    }
 
+    log::info!(
+        "Generated {} test cases ({} new)",
+        num_total,
+        num_interesting
+    );
+
+    let mut state = state.lock().unwrap();
+    if symcc_result.killed {
         log::info!(
-            "Generated {} test cases ({} new)",
-            num_total,
-            num_interesting
+            "The target process was killed (probably timeout or out of memory); \
+             archiving to {}",
+            state.hangs.path.display()
         );
+        symcc::copy_testcase(&input, &mut state.hangs, &input)
+            .context("Failed to archive the test case")?;
+    }
 
-        if symcc_result.killed {
-            log::info!(
-                "The target process was killed (probably timeout or out of memory); \
-                 archiving to {}",
-                self.hangs.path.display()
-            );
-            symcc::copy_testcase(&input, &mut self.hangs, &input)
-                .context("Failed to archive the test case")?;
+    state.stats.add_execution(&symcc_result);
+    Ok(())
+}
+
+/// Analyze AFL's test cases with the given SymCC configuration, in order of
+/// their score, coordinating with the other workers via the shared state.
+///
+/// This function only returns in case of an error.
+fn run_worker(
+    mut symcc: SymCC,
+    mut checker: AflCoverageChecker,
+    afl_config: &AflConfig,
+    state: &Mutex<State>,
+) -> Result<()> {
+    loop {
+        // Claim the test case while holding the lock, so that no other worker
+        // picks it as well.
+        let input = {
+            let mut state = state.lock().unwrap();
+            let best = afl_config
+                .best_new_testcase(&state.processed_files)
+                .context("Failed to check for new test cases")?;
+            if let Some(input) = &best {
+                state.processed_files.insert(input.clone());
+            }
+            best
+        };
+
+        match input {
+            None => {
+                log::debug!("Waiting for new test cases...");
+                thread::sleep(Duration::from_secs(5));
+            }
+            Some(input) => test_input(&input, &mut symcc, &mut checker, afl_config, state)?,
         }
 
-        self.processed_files.insert(input.as_ref().to_path_buf());
-        self.stats.add_execution(&symcc_result);
-        Ok(())
+        state.lock().unwrap().maybe_log_stats();
     }
 }
 
@@ -296,31 +363,61 @@ fn main() -> Result<()> {
         return Ok(());
     }
 
-    let symcc = SymCC::new(symcc_dir.clone(), &options.command);
-    log::debug!("SymCC configuration: {:?}", &symcc);
-    let afl_config = AflConfig::load(options.output_dir.join(&options.fuzzer_name))?;
+    let coverage_map = Arc::new(SharedCoverageMap::new()?);
+    let afl_config = Arc::new(AflConfig::load(
+        options.output_dir.join(&options.fuzzer_name),
+    )?);
     log::debug!("AFL configuration: {:?}", &afl_config);
-    let mut state = State::initialize(symcc_dir)?;
-
-    loop {
-        match afl_config
-            .best_new_testcase(&state.processed_files)
-            .context("Failed to check for new test cases")?
-        {
-            None => {
-                log::debug!("Waiting for new test cases...");
-                thread::sleep(Duration::from_secs(5));
-            }
-            Some(input) => state.test_input(&input, &symcc, &afl_config)?,
+    let state = Arc::new(Mutex::new(State::initialize(&symcc_dir)?));
+
+    // The Qsym backend writes its copy of the coverage map back at exit, so
+    // concurrent executions would overwrite each other's updates.
+    let mut jobs = options.jobs.max(1);
+    if jobs > 1 {
+        let probe = SymCC::new(
+            symcc_dir.clone(),
+            &options.command,
+            false,
+            0,
+            coverage_map.clone(),
+            0,
+        );
+        if probe.uses_qsym_backend()? {
+            log::warn!(
+                "The target uses SymCC's Qsym backend, which can't share its \
+                 coverage map between concurrent executions; running only one \
+                 at a time"
+            );
+            jobs = 1;
         }
+    }
 
-        if state.last_stats_output.elapsed().as_secs() > STATS_INTERVAL_SEC {
-            if let Err(e) = state.stats.log(&mut state.stats_file) {
-                log::error!("Failed to log run-time statistics: {}", e);
-            }
-            state.last_stats_output = Instant::now();
-        }
+    // The workers share the set of processed test cases, the AFL coverage and
+    // SymCC's coverage map; they only report back to us when they fail.
+    let (error_sender, errors) = mpsc::channel();
+    for worker in 0..jobs {
+        let symcc = SymCC::new(
+            symcc_dir.clone(),
+            &options.command,
+            options.fork_server,
+            options.snapshot_offset,
+            coverage_map.clone(),
+            worker,
+        );
+        log::debug!("SymCC configuration of worker {}: {:?}", worker, &symcc);
+        let checker = AflCoverageChecker::new(symcc_dir.join(format!(".afl_input_{}", worker)))?;
+
+        let afl_config = afl_config.clone();
+        let state = state.clone();
+        let error_sender = error_sender.clone();
+        thread::spawn(move || {
+            let result = run_worker(symcc, checker, &afl_config, &state);
+            let _ = error_sender.send(result.with_context(|| format!("Worker {} failed", worker)));
+        });
     }
+    drop(error_sender);
+
+    errors.recv().context("All workers terminated unexpectedly")?
 }
 
 /// The possible outcomes of test-case evaluation.
@@ -334,18 +431,21 @@ enum TestcaseResult {
 
 /// Check if the given test case provides new coverage, crashes, or times out;
 /// copy it to the corresponding location.
+///
+/// We only lock the state after running the test case.
 fn process_new_testcase(
     testcase: impl AsRef<Path>,
     parent: impl AsRef<Path>,
     tmp_dir: impl AsRef<Path>,
+    checker: &mut AflCoverageChecker,
     afl_config: &AflConfig,
-    state: &mut State,
+    state: &Mutex<State>,
 ) -> Result<TestcaseResult> {
     log::debug!("Processing test case {}", testcase.as_ref().display());
 
     let testcase_bitmap_path = tmp_dir.as_ref().join("testcase_bitmap");
-    match afl_config
-        .run_showmap(&testcase_bitmap_path, &testcase)
+    match checker
+        .check(afl_config, &testcase_bitmap_path, &testcase)
         .with_context(|| {
             format!(
                 "Failed to check whether test case {} is interesting",
@@ -353,6 +453,7 @@ fn process_new_testcase(
             )
         })? {
         AflShowmapResult::Success(testcase_bitmap) => {
+            let mut state = state.lock().unwrap();
             let interesting = state.current_bitmap.merge(*testcase_bitmap)?;
             if interesting {
                 symcc::copy_testcase(&testcase, &mut state.queue, parent).with_context(|| {
@@ -369,16 +470,17 @@ fn process_new_testcase(
         }
         AflShowmapResult::Hang => {
             log::info!(
-                "Ignoring new test case {} because afl-showmap timed out on it",
+                "Ignoring new test case {} because the AFL target timed out on it",
                 testcase.as_ref().display()
             );
             Ok(TestcaseResult::Hang)
         }
         AflShowmapResult::Crash => {
             log::info!(
-                "Test case {} crashes afl-showmap; it is probably interesting",
+                "Test case {} crashes the AFL target; it is probably interesting",
                 testcase.as_ref().display()
             );
+            let mut state = state.lock().unwrap();
             symcc::copy_testcase(&testcase, &mut state.crashes, &parent)?;
             symcc::copy_testcase(&testcase, &mut state.queue, &parent).with_context(|| {
                 format!(
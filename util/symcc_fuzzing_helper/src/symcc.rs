@@ -16,17 +16,41 @@ use anyhow::{bail, ensure, Context, Result};
 use regex::Regex;
 use std::cmp;
 use std::collections::HashSet;
-use std::ffi::{OsStr, OsString};
+use std::convert::TryFrom;
+use std::ffi::{CString, OsStr, OsString};
 use std::fs::{self, File};
-use std::io::{self, Read};
-use std::os::unix::process::ExitStatusExt;
+use std::io::{self, Read, Seek, SeekFrom, Write};
+use std::os::unix::io::{AsRawFd, FromRawFd};
+use std::os::unix::process::{CommandExt, ExitStatusExt};
 use std::path::{Path, PathBuf};
-use std::process::{Command, Stdio};
+use std::process::{Child, Command, ExitStatus, Stdio};
+use std::ptr;
 use std::str;
+use std::sync::Arc;
 use std::time::{Duration, Instant};
 
 const TIMEOUT: u32 = 90;
 
+/// The time after which SymCC stops solving, leaving it enough time to finish
+/// the execution concretely before we kill it.
+const SOLVING_DEADLINE: u32 = TIMEOUT - 15;
+
+/// The file descriptors used by the fork server (see
+/// runtime/include/ForkServer.h).
+const FORK_SERVER_CONTROL_FD: i32 = 198;
+const FORK_SERVER_STATUS_FD: i32 = 199;
+
+/// The size of SymCC's coverage map for branch pruning (see
+/// runtime/src/backends/simple/CoverageMap.h).
+const COVERAGE_MAP_SIZE: usize = 1 << 16;
+
+/// The size of AFL's coverage map.
+const AFL_MAP_SIZE: usize = 1 << 16;
+
+/// The time limit for running the AFL-instrumented target on a test case (like
+/// "afl-showmap -t").
+const AFL_TIMEOUT_MS: u64 = 5000;
+
 /// Replace the first '@@' in the given command line with the input file.
 fn insert_input_file<S: AsRef<OsStr>, P: AsRef<Path>>(
     command: &[S],
@@ -394,14 +418,445 @@ impl AflConfig {
     }
 }
 
+/// AFL's coverage map in System V shared memory, where AFL-instrumented programs
+/// expect it (see __AFL_SHM_ID).
+struct AflTraceBits {
+    /// The ID of the shared-memory segment.
+    id: i32,
+
+    /// The segment mapped into our address space.
+    data: *mut u8,
+}
+
+// The map is only ever used by the thread that owns it.
+unsafe impl Send for AflTraceBits {}
+
+impl AflTraceBits {
+    fn new() -> Result<AflTraceBits> {
+        let id = unsafe {
+            libc::shmget(
+                libc::IPC_PRIVATE,
+                AFL_MAP_SIZE,
+                libc::IPC_CREAT | libc::IPC_EXCL | 0o600,
+            )
+        };
+        if id == -1 {
+            return Err(io::Error::last_os_error())
+                .context("Failed to create shared memory for AFL's coverage map");
+        }
+
+        let data = unsafe { libc::shmat(id, ptr::null(), 0) };
+        if data as isize == -1 {
+            let error = io::Error::last_os_error();
+            unsafe { libc::shmctl(id, libc::IPC_RMID, ptr::null_mut()) };
+            return Err(error).context("Failed to map AFL's coverage map");
+        }
+
+        // Linux still lets the target attach to the segment after this, and it
+        // makes sure that the segment disappears when we exit, even if we're
+        // killed.
+        unsafe { libc::shmctl(id, libc::IPC_RMID, ptr::null_mut()) };
+
+        Ok(AflTraceBits {
+            id,
+            data: data as *mut u8,
+        })
+    }
+
+    fn as_slice(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.data, AFL_MAP_SIZE) }
+    }
+
+    fn as_mut_slice(&mut self) -> &mut [u8] {
+        unsafe { std::slice::from_raw_parts_mut(self.data, AFL_MAP_SIZE) }
+    }
+}
+
+impl Drop for AflTraceBits {
+    fn drop(&mut self) {
+        unsafe { libc::shmdt(self.data as *const libc::c_void) };
+    }
+}
+
+/// Bucket hit counts like afl-showmap does in binary mode, so that maps from
+/// either source can be merged.
+fn classify_counts(trace_bits: &[u8]) -> Vec<u8> {
+    trace_bits
+        .iter()
+        .map(|&count| match count {
+            0 => 0,
+            1 => 1,
+            2 => 2,
+            3 => 4,
+            4..=7 => 8,
+            8..=15 => 16,
+            16..=31 => 32,
+            32..=127 => 64,
+            _ => 128,
+        })
+        .collect()
+}
+
+/// A way to run the AFL-instrumented target on test cases and measure their
+/// coverage.
+///
+/// Instead of starting afl-showmap for each test case, we start the target
+/// once as an AFL fork server and let it write coverage to shared memory. If
+/// that doesn't work (e.g., in QEMU mode, or with fork-server protocols other
+/// than classic AFL's), we fall back to afl-showmap.
+pub struct AflCoverageChecker {
+    /// The coverage map shared with the target.
+    trace_bits: AflTraceBits,
+
+    /// The fork server, once it's running.
+    fork_server: Option<ForkServer>,
+
+    /// The file that we pass test cases in.
+    input_file: PathBuf,
+
+    /// If the target reads standard input, our handle to it; the fork server's
+    /// children share its file offset.
+    standard_input: Option<File>,
+
+    /// Do we (still) try to use the fork server?
+    use_fork_server: bool,
+}
+
+impl AflCoverageChecker {
+    /// Create a checker that passes test cases to the target in the given
+    /// file.
+    pub fn new(input_file: PathBuf) -> Result<Self> {
+        Ok(AflCoverageChecker {
+            trace_bits: AflTraceBits::new()?,
+            fork_server: None,
+            input_file,
+            standard_input: None,
+            use_fork_server: true,
+        })
+    }
+
+    /// Run the target on the given test case and report the result like
+    /// afl-showmap would (which we use as a fallback, writing the map to
+    /// testcase_bitmap).
+    pub fn check(
+        &mut self,
+        afl_config: &AflConfig,
+        testcase_bitmap: impl AsRef<Path>,
+        testcase: impl AsRef<Path>,
+    ) -> Result<AflShowmapResult> {
+        if self.use_fork_server && !afl_config.use_qemu_mode {
+            match self.run_in_fork_server(afl_config, testcase.as_ref()) {
+                Ok(result) => return Ok(result),
+                Err(e) => {
+                    log::warn!(
+                        "Failed to run the target in an AFL fork server; \
+                         falling back to afl-showmap: {:#}",
+                        e
+                    );
+                    self.fork_server = None;
+                    self.use_fork_server = false;
+                }
+            }
+        }
+
+        afl_config.run_showmap(testcase_bitmap, testcase)
+    }
+
+    /// Start the AFL-instrumented target as a fork server.
+    fn start_fork_server(&mut self, afl_config: &AflConfig) -> Result<ForkServer> {
+        File::create(&self.input_file).with_context(|| {
+            format!(
+                "Failed to create the input file {} for AFL",
+                self.input_file.display()
+            )
+        })?;
+
+        let target: Vec<_> = afl_config
+            .target_command
+            .iter()
+            .skip_while(|arg| *arg == "--")
+            .collect();
+        ensure!(!target.is_empty(), "The AFL target command is empty");
+        let command_line = insert_input_file(&target, &self.input_file);
+
+        let mut command = Command::new(&command_line[0]);
+        command
+            .args(&command_line[1..])
+            .env("__AFL_SHM_ID", self.trace_bits.id.to_string())
+            .stdout(Stdio::null())
+            .stderr(Stdio::null());
+
+        if afl_config.use_standard_input {
+            let standard_input = File::open(&self.input_file)?;
+            command.stdin(standard_input.try_clone()?);
+            self.standard_input = Some(standard_input);
+        } else {
+            command.stdin(Stdio::null());
+        }
+
+        ForkServer::start(command)
+    }
+
+    fn run_in_fork_server(
+        &mut self,
+        afl_config: &AflConfig,
+        testcase: &Path,
+    ) -> Result<AflShowmapResult> {
+        if self.fork_server.is_none() {
+            self.fork_server = Some(self.start_fork_server(afl_config)?);
+        }
+
+        fs::copy(testcase, &self.input_file).with_context(|| {
+            format!(
+                "Failed to copy the test case {} to {}",
+                testcase.display(),
+                self.input_file.display()
+            )
+        })?;
+        if let Some(standard_input) = &mut self.standard_input {
+            standard_input.seek(SeekFrom::Start(0))?;
+        }
+
+        self.trace_bits.as_mut_slice().fill(0);
+        let server = self.fork_server.as_mut().unwrap();
+        match server.run(Duration::from_millis(AFL_TIMEOUT_MS))? {
+            ForkServerRun::Finished(status) if status.signal().is_some() => {
+                Ok(AflShowmapResult::Crash)
+            }
+            ForkServerRun::Finished(_) => Ok(AflShowmapResult::Success(Box::new(AflMap {
+                data: Some(classify_counts(self.trace_bits.as_slice())),
+            }))),
+            ForkServerRun::Timeout => Ok(AflShowmapResult::Hang),
+            ForkServerRun::Broken(pid) => {
+                bail!("The fork server reported the invalid PID {}", pid)
+            }
+        }
+    }
+}
+
+/// Create a pipe whose ends are closed on exec.
+fn pipe() -> Result<(File, File)> {
+    let mut fds = [0; 2];
+    if unsafe { libc::pipe2(fds.as_mut_ptr(), libc::O_CLOEXEC) } != 0 {
+        return Err(io::Error::last_os_error()).context("Failed to create a pipe");
+    }
+
+    Ok(unsafe { (File::from_raw_fd(fds[0]), File::from_raw_fd(fds[1])) })
+}
+
+/// Wait until there is data to read from the file.
+///
+/// Return false if the timeout expires first.
+fn wait_readable(file: &File, timeout: Duration) -> Result<bool> {
+    let mut poll_fd = libc::pollfd {
+        fd: file.as_raw_fd(),
+        events: libc::POLLIN,
+        revents: 0,
+    };
+    let millis = cmp::min(timeout.as_millis(), libc::c_int::MAX as u128) as libc::c_int;
+
+    loop {
+        match unsafe { libc::poll(&mut poll_fd, 1, millis) } {
+            -1 => {
+                let error = io::Error::last_os_error();
+                if error.kind() != io::ErrorKind::Interrupted {
+                    return Err(error).context("Failed to poll the fork server");
+                }
+            }
+            0 => return Ok(false),
+            _ => return Ok(true),
+        }
+    }
+}
+
+/// SymCC's coverage map for branch pruning, kept in POSIX shared memory (see
+/// SYMCC_AFL_COVERAGE_SHM in docs/Configuration.txt).
+///
+/// All executions of the target update the map in place, so they see each
+/// other's progress immediately. The map lives as long as this object.
+#[derive(Debug)]
+pub struct SharedCoverageMap {
+    /// The name of the shared-memory object.
+    name: String,
+}
+
+impl SharedCoverageMap {
+    /// Create a fresh map.
+    pub fn new() -> Result<SharedCoverageMap> {
+        let name = format!("/symcc-coverage-{}", std::process::id());
+        let c_name = CString::new(name.clone()).expect("Invalid shared-memory name");
+        let fd = unsafe {
+            libc::shm_open(
+                c_name.as_ptr(),
+                libc::O_RDWR | libc::O_CREAT | libc::O_EXCL,
+                0o600,
+            )
+        };
+        if fd == -1 {
+            return Err(io::Error::last_os_error())
+                .with_context(|| format!("Failed to create the coverage map {}", name));
+        }
+
+        // From here on, dropping the map removes the shared-memory object.
+        let map = SharedCoverageMap { name };
+        let mut file = unsafe { File::from_raw_fd(fd) };
+        file.write_all(&[0xff; COVERAGE_MAP_SIZE])
+            .with_context(|| format!("Failed to initialize the coverage map {}", map.name))?;
+        Ok(map)
+    }
+}
+
+impl Drop for SharedCoverageMap {
+    fn drop(&mut self) {
+        let c_name = CString::new(self.name.clone()).unwrap();
+        unsafe { libc::shm_unlink(c_name.as_ptr()) };
+    }
+}
+
+/// A target program running as a fork server (see SYMCC_FORK_SERVER in
+/// docs/Configuration.txt).
+#[derive(Debug)]
+struct ForkServer {
+    /// The server process.
+    process: Child,
+
+    /// Our end of the pipe for requests.
+    control: File,
+
+    /// Our end of the pipe for responses.
+    status: File,
+
+    /// The message that the server announced itself with.
+    hello: u32,
+}
+
+/// The outcome of running the target in the fork server.
+enum ForkServerRun {
+    /// The child terminated, either normally or because of a signal.
+    Finished(ExitStatus),
+    /// The child didn't finish in time, so we killed it.
+    Timeout,
+    /// The server reported a PID that can't be its child's, so we can't trust
+    /// it anymore.
+    Broken(u32),
+}
+
+impl ForkServer {
+    /// Start the fork server and wait for it to announce itself.
+    fn start(mut command: Command) -> Result<ForkServer> {
+        let (control_read, control_write) = pipe()?;
+        let (status_read, status_write) = pipe()?;
+        let control_fd = control_read.as_raw_fd();
+        let status_fd = status_write.as_raw_fd();
+        unsafe {
+            command.pre_exec(move || {
+                // dup2 clears the close-on-exec flag on the new descriptors.
+                if libc::dup2(control_fd, FORK_SERVER_CONTROL_FD) == -1
+                    || libc::dup2(status_fd, FORK_SERVER_STATUS_FD) == -1
+                {
+                    return Err(io::Error::last_os_error());
+                }
+
+                Ok(())
+            });
+        }
+
+        log::debug!("Starting the fork server as follows: {:?}", &command);
+        let process = command
+            .spawn()
+            .context("Failed to start the fork server")?;
+
+        // Close the server's ends, so that we notice when it exits.
+        drop(control_read);
+        drop(status_write);
+
+        let mut server = ForkServer {
+            process,
+            control: control_write,
+            status: status_read,
+            hello: 0,
+        };
+        server.hello = server
+            .receive(Duration::from_secs(TIMEOUT.into()))?
+            .context("The fork server didn't start in time")?;
+        Ok(server)
+    }
+
+    /// Receive a message from the server.
+    ///
+    /// Return None if nothing arrives before the timeout expires.
+    fn receive(&mut self, timeout: Duration) -> Result<Option<u32>> {
+        if !wait_readable(&self.status, timeout)? {
+            return Ok(None);
+        }
+
+        let mut message = [0; 4];
+        self.status
+            .read_exact(&mut message)
+            .context("Failed to receive a message from the fork server")?;
+        Ok(Some(u32::from_ne_bytes(message)))
+    }
+
+    /// Run the target once, killing it if it exceeds the timeout.
+    fn run(&mut self, timeout: Duration) -> Result<ForkServerRun> {
+        self.control
+            .write_all(&[0; 4])
+            .context("Failed to send a request to the fork server")?;
+        let pid = self
+            .receive(timeout)?
+            .context("The fork server didn't report the child's PID")?;
+        // Signaling 0 or a negative PID would hit entire process groups.
+        let child = match libc::pid_t::try_from(pid) {
+            Ok(child) if child > 0 => child,
+            _ => return Ok(ForkServerRun::Broken(pid)),
+        };
+
+        match self.receive(timeout)? {
+            Some(status) => Ok(ForkServerRun::Finished(ExitStatus::from_raw(
+                status as i32,
+            ))),
+            None => {
+                unsafe { libc::kill(child, libc::SIGKILL) };
+                self.receive(timeout)?
+                    .context("The fork server didn't report the killed child's status")?;
+                Ok(ForkServerRun::Timeout)
+            }
+        }
+    }
+}
+
+impl Drop for ForkServer {
+    fn drop(&mut self) {
+        // The server exits when we close the control pipe, but it may be busy.
+        let _ = self.process.kill();
+        let _ = self.process.wait();
+    }
+}
+
 /// The run-time configuration of SymCC.
 #[derive(Debug)]
 pub struct SymCC {
     /// Do we pass data to standard input?
     use_standard_input: bool,
 
-    /// The cumulative bitmap for branch pruning.
-    bitmap: PathBuf,
+    /// Do we run the target as a fork server?
+    use_fork_server: bool,
+
+    /// The number of input bytes that the fork server consumes before forking.
+    snapshot_offset: u32,
+
+    /// The fork server, once it's running.
+    fork_server: Option<ForkServer>,
+
+    /// The part of the input that the fork server consumed before forking; it
+    /// can only run inputs that start with the same bytes.
+    fork_server_prefix: Vec<u8>,
+
+    /// The directory where the fork server's children store new test cases.
+    fork_server_output: PathBuf,
+
+    /// The cumulative coverage map for branch pruning, shared by all workers.
+    coverage_map: Arc<SharedCoverageMap>,
 
     /// The place to store the current input.
     input_file: PathBuf,
@@ -424,17 +879,57 @@ pub struct SymCCResult {
 
 impl SymCC {
     /// Create a new SymCC configuration.
-    pub fn new(output_dir: PathBuf, command: &[String]) -> Self {
-        let input_file = output_dir.join(".cur_input");
+    ///
+    /// Several configurations can be used concurrently as long as they have
+    /// different worker IDs, which determine the names of their temporary
+    /// files.
+    pub fn new(
+        output_dir: PathBuf,
+        command: &[String],
+        use_fork_server: bool,
+        snapshot_offset: u32,
+        coverage_map: Arc<SharedCoverageMap>,
+        worker: usize,
+    ) -> Self {
+        let input_file = output_dir.join(format!(".cur_input_{}", worker));
 
         SymCC {
             use_standard_input: !command.contains(&String::from("@@")),
-            bitmap: output_dir.join("bitmap"),
+            use_fork_server,
+            snapshot_offset,
+            fork_server: None,
+            fork_server_prefix: Vec::new(),
+            fork_server_output: output_dir.join(format!(".fork_server_output_{}", worker)),
+            coverage_map,
             command: insert_input_file(command, &input_file),
             input_file,
         }
     }
 
+    /// Determine whether the target uses the Qsym backend.
+    ///
+    /// We run the target once without symbolic input and look for the
+    /// backend's greeting, which it prints during initialization.
+    pub fn uses_qsym_backend(&self) -> Result<bool> {
+        File::create(&self.input_file).with_context(|| {
+            format!(
+                "Failed to create the test input at {}",
+                self.input_file.display()
+            )
+        })?;
+
+        let output = Command::new("timeout")
+            .args(&["-k", "5", &TIMEOUT.to_string()])
+            .args(&self.command)
+            .env("SYMCC_NO_SYMBOLIC_INPUT", "1")
+            .stdin(Stdio::null())
+            .stdout(Stdio::null())
+            .stderr(Stdio::piped())
+            .output()
+            .context("Failed to run the target to determine SymCC's backend")?;
+        Ok(String::from_utf8_lossy(&output.stderr).contains("with the QSYM backend"))
+    }
+
     /// Try to extract the solver time from the logs produced by the Qsym
     /// backend.
     fn parse_solver_time(output: Vec<u8>) -> Option<Duration> {
@@ -456,15 +951,186 @@ impl SymCC {
             .next()
     }
 
+    /// Set up the environment of the target for analysis.
+    fn configure_command(&self, command: &mut Command, output_dir: impl AsRef<Path>) {
+        command
+            .env("SYMCC_ENABLE_LINEARIZATION", "1")
+            .env("SYMCC_SITE_BACKOFF", "1")
+            .env("SYMCC_SOLVING_DEADLINE", SOLVING_DEADLINE.to_string())
+            .env("SYMCC_AFL_COVERAGE_SHM", &self.coverage_map.name)
+            .env("SYMCC_OUTPUT_DIR", output_dir.as_ref())
+            .stdout(Stdio::null());
+
+        if !self.use_standard_input {
+            command.env("SYMCC_INPUT_FILE", &self.input_file);
+        }
+    }
+
+    /// Start the target as a fork server.
+    fn start_fork_server(&self) -> Result<ForkServer> {
+        fs::create_dir_all(&self.fork_server_output).with_context(|| {
+            format!(
+                "Failed to create the output directory {} for the fork server",
+                self.fork_server_output.display()
+            )
+        })?;
+
+        let mut command = Command::new(&self.command[0]);
+        command
+            .args(&self.command[1..])
+            .env("SYMCC_FORK_SERVER", "1")
+            .env("SYMCC_SNAPSHOT_OFFSET", self.snapshot_offset.to_string())
+            .stderr(Stdio::null());
+        self.configure_command(&mut command, &self.fork_server_output);
+
+        // The children rewind standard input, so it needs to be a file.
+        if self.use_standard_input {
+            command.stdin(File::open(&self.input_file).with_context(|| {
+                format!(
+                    "Failed to open the test input at {}",
+                    self.input_file.display()
+                )
+            })?);
+        } else {
+            command.stdin(Stdio::null());
+        }
+
+        let server = ForkServer::start(command)?;
+        log::debug!("The fork server started after {} input bytes", server.hello);
+        Ok(server)
+    }
+
+    /// Run SymCC on the current input in the fork server, starting the server
+    /// if necessary.
+    ///
+    /// Return None if the server can't be started; the caller should fall back
+    /// to regular execution in that case.
+    fn run_in_fork_server(&mut self, output_dir: &Path) -> Result<Option<SymCCResult>> {
+        let input = fs::read(&self.input_file).with_context(|| {
+            format!(
+                "Failed to read the test input at {}",
+                self.input_file.display()
+            )
+        })?;
+
+        // A server that forked after a different prefix would replay the
+        // wrong execution up to the snapshot.
+        if self.fork_server.is_some() && !input.starts_with(&self.fork_server_prefix) {
+            log::debug!("The input diverges before the snapshot; restarting the fork server");
+            self.fork_server = None;
+        }
+
+        if self.fork_server.is_none() {
+            match self.start_fork_server() {
+                Ok(server) => {
+                    let prefix_length = input.len().min(server.hello as usize);
+                    self.fork_server_prefix = input[..prefix_length].to_vec();
+                    self.fork_server = Some(server);
+                }
+                Err(e) => {
+                    log::warn!(
+                        "Failed to start the fork server; falling back to \
+                         regular execution: {:#}",
+                        e
+                    );
+                    self.use_fork_server = false;
+                    return Ok(None);
+                }
+            }
+        }
+
+        let server = self.fork_server.as_mut().unwrap();
+        let start = Instant::now();
+        let killed = match server.run(Duration::from_secs(TIMEOUT.into())) {
+            Ok(ForkServerRun::Finished(status)) => {
+                log::debug!("SymCC returned {}", status);
+                let maybe_sig = status.signal();
+                if let Some(signal) = maybe_sig {
+                    log::warn!("SymCC received signal {}", signal);
+                }
+                maybe_sig.is_some()
+            }
+            Ok(ForkServerRun::Timeout) => {
+                log::debug!("SymCC timed out");
+                true
+            }
+            Ok(ForkServerRun::Broken(pid)) => {
+                log::warn!(
+                    "The fork server reported the invalid PID {}; falling back \
+                     to regular execution",
+                    pid
+                );
+                self.fork_server = None;
+                self.use_fork_server = false;
+                return Ok(None);
+            }
+            Err(e) => {
+                log::warn!("Lost the fork server; restarting it: {:#}", e);
+                self.fork_server = None;
+                true
+            }
+        };
+        let total_time = start.elapsed();
+
+        // The children all write to the same directory, so move their results
+        // out of the way.
+        for entry in fs::read_dir(&self.fork_server_output).with_context(|| {
+            format!(
+                "Failed to read the generated test cases at {}",
+                self.fork_server_output.display()
+            )
+        })? {
+            let path = entry?.path();
+            let target = output_dir.join(path.file_name().unwrap());
+            fs::copy(&path, &target)
+                .and_then(|_| fs::remove_file(&path))
+                .with_context(|| {
+                    format!(
+                        "Failed to move the test case {} to {}",
+                        path.display(),
+                        output_dir.display()
+                    )
+                })?;
+        }
+
+        Ok(Some(SymCCResult {
+            test_cases: SymCC::collect_test_cases(output_dir)?,
+            killed,
+            time: total_time,
+            solver_time: None,
+        }))
+    }
+
+    /// List the test cases in the given output directory.
+    fn collect_test_cases(output_dir: impl AsRef<Path>) -> Result<Vec<PathBuf>> {
+        Ok(fs::read_dir(&output_dir)
+            .with_context(|| {
+                format!(
+                    "Failed to read the generated test cases at {}",
+                    output_dir.as_ref().display()
+                )
+            })?
+            .collect::<io::Result<Vec<_>>>()
+            .with_context(|| {
+                format!(
+                    "Failed to read all test cases from {}",
+                    output_dir.as_ref().display()
+                )
+            })?
+            .iter()
+            .map(|entry| entry.path())
+            .collect())
+    }
+
     /// Run SymCC on the given input, writing results to the provided temporary
     /// directory.
     ///
     /// If SymCC is run with the Qsym backend, this function attempts to
     /// determine the time spent in the SMT solver and report it as part of the
     /// result. However, the mechanism that the backend uses to report solver
-    /// time is somewhat brittle.
+    /// time is somewhat brittle, and it doesn't work in fork-server mode.
     pub fn run(
-        &self,
+        &mut self,
         input: impl AsRef<Path>,
         output_dir: impl AsRef<Path>,
     ) -> Result<SymCCResult> {
@@ -483,21 +1149,23 @@ impl SymCC {
             )
         })?;
 
+        if self.use_fork_server {
+            if let Some(result) = self.run_in_fork_server(output_dir.as_ref())? {
+                return Ok(result);
+            }
+        }
+
         let mut analysis_command = Command::new("timeout");
         analysis_command
             .args(&["-k", "5", &TIMEOUT.to_string()])
             .args(&self.command)
-            .env("SYMCC_ENABLE_LINEARIZATION", "1")
-            .env("SYMCC_AFL_COVERAGE_MAP", &self.bitmap)
-            .env("SYMCC_OUTPUT_DIR", output_dir.as_ref())
-            .stdout(Stdio::null())
             .stderr(Stdio::piped()); // capture SMT logs
+        self.configure_command(&mut analysis_command, &output_dir);
 
         if self.use_standard_input {
             analysis_command.stdin(Stdio::piped());
         } else {
             analysis_command.stdin(Stdio::null());
-            analysis_command.env("SYMCC_INPUT_FILE", &self.input_file);
         }
 
         log::debug!("Running SymCC as follows: {:?}", &analysis_command);
@@ -538,23 +1206,7 @@ impl SymCC {
             }
         };
 
-        let new_tests = fs::read_dir(&output_dir)
-            .with_context(|| {
-                format!(
-                    "Failed to read the generated test cases at {}",
-                    output_dir.as_ref().display()
-                )
-            })?
-            .collect::<io::Result<Vec<_>>>()
-            .with_context(|| {
-                format!(
-                    "Failed to read all test cases from {}",
-                    output_dir.as_ref().display()
-                )
-            })?
-            .iter()
-            .map(|entry| entry.path())
-            .collect();
+        let new_tests = SymCC::collect_test_cases(&output_dir)?;
 
         let solver_time = SymCC::parse_solver_time(result.stderr);
         if solver_time.is_some() && solver_time.unwrap() > total_time {